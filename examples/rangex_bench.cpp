@@ -0,0 +1,524 @@
+#ifdef _MSC_VER
+#define COMPILER_HAS_NO_STD_FLOAT
+#endif
+
+#include "rangex_lib.h"
+#include "rangex_parallel.h"
+#include "rangex_histogram.h"
+#include "rangex_resumable.h"
+using namespace ns_rangex;
+
+#include <iostream>
+#include <cstdint>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <complex>
+
+// Keep the optimizer from dropping a computed value
+template <typename T>
+void do_not_optimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T sink;
+    sink = value;
+#endif
+}
+
+// Best of `repeat` runs, in nanoseconds per element
+template <typename Fn>
+double bench_ns_per_element(std::size_t elements, Fn&& fn, int repeat = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repeat; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        best = ns < best ? ns : best;
+    }
+    return best / static_cast<double>(elements ? elements : 1);
+}
+
+template <typename T, std::size_t Unroll>
+void bench_unroll_one(const char *type_name, rangex<T> r) {
+    double for_each_ns = bench_ns_per_element(r.size(), [&r] {
+        T acc = 0;
+        r.template for_each<Unroll>([&acc](T v) { acc = static_cast<T>(acc + v); });
+        do_not_optimize(acc);
+    });
+    double reduce_ns = bench_ns_per_element(r.size(), [&r] {
+        do_not_optimize(r.template reduce<Unroll>(T{0}));
+    });
+    std::printf("%-8s unroll %2zu  for_each %7.3f ns/elem  reduce %7.3f ns/elem\n",
+        type_name, Unroll, for_each_ns, reduce_ns);
+}
+
+template <typename T>
+void bench_unroll(const char *type_name, rangex<T> r) {
+    double range_for_ns = bench_ns_per_element(r.size(), [&r] {
+        T acc = 0;
+        for (auto v : r) {
+            acc += v;
+        }
+        do_not_optimize(acc);
+    });
+    std::printf("%-8s range-for          %7.3f ns/elem\n", type_name, range_for_ns);
+    bench_unroll_one<T, 1>(type_name, r);
+    bench_unroll_one<T, 2>(type_name, r);
+    bench_unroll_one<T, 4>(type_name, r);
+    bench_unroll_one<T, 8>(type_name, r);
+    bench_unroll_one<T, 16>(type_name, r);
+}
+
+void bench_concurrent_cursor(const char *name, schedule_kind kind, std::size_t chunk) {
+    const auto r = rangex<std::uint64_t>(0, 1 << 24);
+    for (std::size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        std::atomic<std::size_t> claims{0};
+        double ns = bench_ns_per_element(r.size(), [&] {
+            concurrent_cursor<rangex<std::uint64_t>> cursor(r, chunk, kind, threads);
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&cursor, &claims] {
+                    std::uint64_t acc = 0;
+                    std::size_t my_claims = 0;
+                    while (auto part = cursor.try_next()) {
+                        acc += part->reduce<4>(std::uint64_t{0});
+                        my_claims++;
+                    }
+                    do_not_optimize(acc);
+                    claims.fetch_add(my_claims, std::memory_order_relaxed);
+                });
+            }
+            for (auto& w : workers) {
+                w.join();
+            }
+        }, 3);
+        std::printf("%-8s chunk %4zu threads %2zu  %7.3f ns/elem  %9zu claims/run\n",
+            name, chunk, threads, ns, claims.load() / 3);
+    }
+}
+
+// Work of each of `parts` workers on an all-pairs distance sum over n points: rows split
+// evenly (the nested loop) against balanced_part() of the triangular_rangex
+void bench_triangular_balance(std::size_t n, std::size_t parts) {
+    std::vector<float> x(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<float>(i % 97) * 0.5f;
+    }
+    auto pair_kernel = [&x](std::size_t i, std::size_t j) {
+        float d = x[i] - x[j];
+        return d * d;
+    };
+    double row_max_ns = 0, row_sum_ns = 0, tri_max_ns = 0, tri_sum_ns = 0;
+    std::size_t row_max_pairs = 0, tri_max_pairs = 0;
+    for (std::size_t k = 0; k < parts; ++k) {
+        auto rows = balanced_part(rangex<std::size_t>(0, n), parts, k);
+        std::size_t pairs = 0;
+        double ns = bench_ns_per_element(1, [&] {
+            float acc = 0;
+            for (auto i : rows) {
+                for (auto j : rangex<std::size_t>(i + 1, n)) {
+                    acc += pair_kernel(i, j);
+                }
+                pairs += n - i - 1;
+            }
+            do_not_optimize(acc);
+        }, 3);
+        row_max_ns = std::max(row_max_ns, ns);
+        row_sum_ns += ns;
+        row_max_pairs = std::max(row_max_pairs, pairs / 3);
+
+        auto tri = balanced_part(triangular_rangex(n), parts, k);
+        ns = bench_ns_per_element(1, [&] {
+            float acc = 0;
+            for (auto [i, j] : tri) {
+                acc += pair_kernel(i, j);
+            }
+            do_not_optimize(acc);
+        }, 3);
+        tri_max_ns = std::max(tri_max_ns, ns);
+        tri_sum_ns += ns;
+        tri_max_pairs = std::max(tri_max_pairs, tri.size());
+    }
+    const double mean_pairs = static_cast<double>(triangular_rangex(n).size()) / static_cast<double>(parts);
+    // Max over mean is the parallel slowdown caused by the slowest worker, 1.0 is perfect
+    std::printf("n %6zu parts %2zu  row chunks: max/mean pairs %5.2f time %5.2f   triangular: max/mean pairs %5.2f time %5.2f\n",
+        n, parts,
+        static_cast<double>(row_max_pairs) / mean_pairs, row_max_ns / (row_sum_ns / static_cast<double>(parts)),
+        static_cast<double>(tri_max_pairs) / mean_pairs, tri_max_ns / (tri_sum_ns / static_cast<double>(parts)));
+}
+
+// Cost of the type erased any_rangex against the same batches filled through rangex<T>::fill()
+template <typename T, std::size_t Batch>
+void bench_any_rangex(const char *type_name, rangex<T> r) {
+    alignas(64) T buffer[Batch];
+    auto consume = [](const T* data, std::size_t n) {
+        T acc = 0;
+        for (std::size_t k = 0; k < n; ++k) {
+            acc = static_cast<T>(acc + data[k]);
+        }
+        return acc;
+    };
+    double scalar_ns = bench_ns_per_element(r.size(), [&] {
+        T acc = 0;
+        for (auto v : r) {
+            acc = static_cast<T>(acc + v);
+        }
+        do_not_optimize(acc);
+    }, 9);
+    // Batch size unknown to the compiler in both paths, the difference left is the dispatch.
+    // Typed and erased runs alternate, so both see the same machine state
+    volatile std::size_t batch_size = Batch;
+    any_rangex any = r;
+    do_not_optimize(any);
+    double typed_ns = 1e300, erased_ns = 1e300;
+    for (int rep = 0; rep < 15; ++rep) {
+        typed_ns = std::min(typed_ns, bench_ns_per_element(r.size(), [&] {
+            T acc = 0;
+            const std::size_t batch = batch_size;
+            for (std::size_t first = 0; first < r.size(); first += batch) {
+                std::size_t n = r.fill(first, buffer, batch);
+                do_not_optimize(buffer[0]);
+                acc = static_cast<T>(acc + consume(buffer, n));
+            }
+            do_not_optimize(acc);
+        }, 1));
+        erased_ns = std::min(erased_ns, bench_ns_per_element(r.size(), [&] {
+            T acc = 0;
+            any.for_each_batch(std::span<T>(buffer, batch_size), [&](std::span<const T> batch) {
+                do_not_optimize(buffer[0]);
+                acc = static_cast<T>(acc + consume(batch.data(), batch.size()));
+            });
+            do_not_optimize(acc);
+        }, 1));
+    }
+    // The end to end difference is below timer noise, so time the dispatch on its own:
+    // one-value fills, inlined typed call against the call through the function pointer
+    constexpr std::size_t calls = std::size_t{1} << 20;
+    double typed_call_ns = bench_ns_per_element(calls, [&] {
+        for (std::size_t i = 0; i < calls; ++i) {
+            do_not_optimize(r.fill(i & 1023, buffer, 1));
+        }
+    }, 9);
+    double erased_call_ns = bench_ns_per_element(calls, [&] {
+        for (std::size_t i = 0; i < calls; ++i) {
+            do_not_optimize(any.fill(i & 1023, static_cast<void*>(buffer), 1));
+        }
+    }, 9);
+    const double dispatch_ns = std::max(0.0, erased_call_ns - typed_call_ns);
+    const double share = 100.0 * dispatch_ns / static_cast<double>(Batch) / scalar_ns;
+    // Smallest batch that keeps the dispatch below 1% of the range-for
+    const double min_batch = std::ceil(dispatch_ns / (0.01 * scalar_ns));
+    std::printf("%-8s batch %5zu  range-for %6.3f  typed fill %6.3f  any_rangex %6.3f ns/elem"
+        "  dispatch %5.2f ns/batch = %5.2f%% of range-for (below 1%% from batch %.0f)\n",
+        type_name, Batch, scalar_ns, typed_ns, erased_ns, dispatch_ns, share, min_batch);
+}
+
+// Bucket of each key: binary search over materialized edges, rangex::lower_bound() with a
+// hardware divide, and rangex_lookup with the divide strength reduced to multiply-shift
+template <typename T>
+void bench_inverse_queries(const char *type_name, rangex<T> r, std::size_t keys) {
+    std::vector<T> edges;
+    for (std::size_t k = 0; k < r.size(); ++k) {
+        edges.push_back(r[k]);
+    }
+    std::vector<T> probe(keys);
+    std::uint64_t x = 88172645463325252ull;
+    const auto span = static_cast<std::uint64_t>(edges.back() - edges.front()) + 1;
+    for (auto& p : probe) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        p = static_cast<T>(edges.front() + static_cast<T>(x % span));
+    }
+    double search_ns = bench_ns_per_element(keys, [&] {
+        std::size_t acc = 0;
+        for (T v : probe) {
+            acc += static_cast<std::size_t>(std::lower_bound(edges.begin(), edges.end(), v) - edges.begin());
+        }
+        do_not_optimize(acc);
+    });
+    double plain_ns = bench_ns_per_element(keys, [&] {
+        std::size_t acc = 0;
+        for (T v : probe) {
+            acc += r.lower_bound(v);
+        }
+        do_not_optimize(acc);
+    });
+    rangex_lookup<T> lookup(r);
+    double fast_ns = bench_ns_per_element(keys, [&] {
+        std::size_t acc = 0;
+        for (T v : probe) {
+            acc += lookup.lower_bound(v);
+        }
+        do_not_optimize(acc);
+    });
+    std::printf("%-8s %7zu buckets  binary search %6.3f  lower_bound %6.3f  rangex_lookup %6.3f ns/key\n",
+        type_name, r.size(), search_ns, plain_ns, fast_ns);
+}
+
+// Binning throughput: floor() per element into one counter array, against histogram()
+template <typename T>
+void bench_histogram(const char *type_name, std::size_t bins, std::size_t values) {
+    const auto edges = rangex<T>(T{0}, static_cast<T>(bins), true, 1);
+    std::vector<T> data(values);
+    std::uint32_t x = 2463534242u;
+    for (auto& v : data) {
+        x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+        if constexpr (std::is_floating_point_v<T>) {
+            v = static_cast<T>(x % (bins * 1024 + 2048)) / T{1024} - T{1};
+        } else {
+            v = static_cast<T>(x % (bins + 2)) - 1;
+        }
+    }
+    const double bytes = static_cast<double>(values * sizeof(T));
+    double naive_ns = bench_ns_per_element(values, [&] {
+        std::vector<std::uint64_t> counts(bins + 2, 0);
+        for (T v : data) {
+            T t = v;
+            if constexpr (std::is_floating_point_v<T>) {
+                t = std::floor(v);
+            }
+            std::size_t slot = t < 0 ? bins : t >= static_cast<T>(bins) ? bins + 1 : static_cast<std::size_t>(t);
+            counts[slot]++;
+        }
+        do_not_optimize(counts[0]);
+    }, 3);
+    std::printf("%-6s bins %6zu  %s loop %5.2f GB/s", type_name, bins,
+        std::is_floating_point_v<T> ? "floor()" : "compare", bytes / (naive_ns * static_cast<double>(values)));
+    const char *isa_names[] = { "scalar", "AVX2", "AVX-512" };
+    for (auto isa : { histogram_detail::simd_isa::scalar, histogram_detail::simd_isa::avx2, histogram_detail::simd_isa::avx512 }) {
+        if (static_cast<int>(isa) > static_cast<int>(histogram_detail::detected_isa())) {
+            continue;
+        }
+        double ns = bench_ns_per_element(values, [&] {
+            histogram_result h;
+            h.bins.assign(bins, 0);
+            histogram_detail::count_into(edges, std::span<const T>(data), h, isa);
+            do_not_optimize(h.overflow);
+        }, 3);
+        std::printf("  %s %5.2f GB/s", isa_names[static_cast<int>(isa)], bytes / (ns * static_cast<double>(values)));
+    }
+    double threads_ns = bench_ns_per_element(values, [&] {
+        do_not_optimize(histogram(edges, std::span<const T>(data), 4).overflow);
+    }, 3);
+    std::printf("  4 threads %5.2f GB/s\n", bytes / (threads_ns * static_cast<double>(values)));
+}
+
+// Same loop over the same values, only the constructor differs between policies
+template <typename T, overflow_policy Overflow>
+double bench_overflow_one(T first, T last, make_signed_custom_t<T> step) {
+    auto r = rangex<T, false, false, Overflow>(first, last, false, step);
+    return bench_ns_per_element(r.size(), [&r] {
+        T acc = 0;
+        for (auto v : r) {
+            acc = static_cast<T>(acc + v);
+        }
+        do_not_optimize(acc);
+    });
+}
+
+template <typename T>
+void bench_overflow_policy(const char *type_name, T first, T last, make_signed_custom_t<T> step) {
+    std::printf("%-8s range-for  unchecked %7.3f  checked %7.3f  widen %7.3f ns/elem\n", type_name,
+        bench_overflow_one<T, overflow_policy::unchecked>(first, last, step),
+        bench_overflow_one<T, overflow_policy::checked>(first, last, step),
+        bench_overflow_one<T, overflow_policy::widen>(first, last, step));
+}
+
+// Deterministic tree against the plain left to right loop, the result bits are printed to show they match
+void bench_parallel_reduce(reduce_compensation compensation, const char *name) {
+    const auto r = rangex<double>(0.0, 100.0, false, 1e-5);
+    const auto wave = [](double x) { return std::sin(x); };
+    double plain_ns = bench_ns_per_element(r.size(), [&] {
+        double acc = 0;
+        for (auto v : r) {
+            acc += wave(v);
+        }
+        do_not_optimize(acc);
+    }, 3);
+    std::printf("%-8s loop %6.3f ns/elem", name, plain_ns);
+    for (std::size_t threads : {1, 2, 4, 8}) {
+        double sum = 0;
+        double ns = bench_ns_per_element(r.size(), [&] {
+            sum = parallel_reduce(r, 0.0, wave, std::plus<>(), threads, compensation);
+        }, 3);
+        std::printf("  %zu thread %6.3f (%a)", threads, ns, sum);
+    }
+    std::printf("\n");
+}
+
+// Cost of slicing a scan into time budgeted run_for() calls, and the longest slice seen
+template <std::size_t CheckEvery>
+void bench_resumable_one(const rangex<std::int32_t>& r) {
+    double worst_us = 0;
+    double ns = bench_ns_per_element(r.size(), [&] {
+        resumable_cursor<rangex<std::int32_t>, CheckEvery> cursor(r);
+        std::int32_t acc = 0;
+        while (!cursor.done()) {
+            auto t0 = std::chrono::steady_clock::now();
+            cursor.run_for(std::chrono::microseconds(20), [&acc](std::int32_t v) { acc += v; });
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            worst_us = us > worst_us ? us : worst_us;
+        }
+        do_not_optimize(acc);
+    }, 3);
+    std::printf("  check every %5zu  %6.3f ns/elem  longest slice %6.1f us\n", CheckEvery, ns, worst_us);
+}
+
+void bench_resumable(const rangex<std::int32_t>& r) {
+    double plain_ns = bench_ns_per_element(r.size(), [&r] {
+        std::int32_t acc = 0;
+        for (auto v : r) {
+            acc += v;
+        }
+        do_not_optimize(acc);
+    });
+    std::printf("  range-for          %6.3f ns/elem\n", plain_ns);
+    bench_resumable_one<1>(r);
+    bench_resumable_one<64>(r);
+    bench_resumable_one<1024>(r);
+    bench_resumable_one<16384>(r);
+}
+
+// Radix-2 FFT: bit-reversal permutation of the input, then log2(n) passes of butterflies
+void fft_butterflies(std::vector<std::complex<double>>& a) {
+    const std::size_t n = a.size();
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        const double angle = -2.0 * 3.14159265358979323846 / static_cast<double>(len);
+        const std::complex<double> w_len(std::cos(angle), std::sin(angle));
+        for (std::size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1.0, 0.0);
+            for (std::size_t j = 0; j < len / 2; ++j) {
+                const std::complex<double> u = a[i + j];
+                const std::complex<double> v = a[i + j + len / 2] * w;
+                a[i + j] = u + v;
+                a[i + j + len / 2] = u - v;
+                w *= w_len;
+            }
+        }
+    }
+}
+
+void bench_fft_bit_reversal(unsigned bits) {
+    const std::size_t n = std::size_t{1} << bits;
+    std::vector<std::complex<double>> input(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        input[k] = { std::sin(0.001 * static_cast<double>(k * k)), std::cos(0.37 * static_cast<double>(k)) };
+    }
+    const auto order = bit_reversed(rangex<std::uint32_t>(0, static_cast<std::uint32_t>(n)));
+    std::vector<std::uint32_t> indices(n);
+    auto naive = [&](std::vector<std::complex<double>>& a) {
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t j = 0;
+            for (unsigned b = 0; b < bits; ++b) {
+                j |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            if (i < j) {
+                std::swap(a[i], a[j]);
+            }
+        }
+    };
+    auto incremental = [&](std::vector<std::complex<double>>& a) {
+        std::size_t i = 0;
+        for (auto j : order) {
+            if (i < j) {
+                std::swap(a[i], a[j]);
+            }
+            ++i;
+        }
+    };
+    auto batch = [&](std::vector<std::complex<double>>& a) {
+        order.fill(0, indices.data(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (i < indices[i]) {
+                std::swap(a[i], a[indices[i]]);
+            }
+        }
+    };
+    std::vector<std::complex<double>> a, reference = input;
+    naive(reference);
+    fft_butterflies(reference);
+    std::printf("n = 2^%u", bits);
+    auto run = [&](const char *name, auto permute) {
+        double permute_ns = bench_ns_per_element(n, [&] {
+            a = input;
+            permute(a);
+            do_not_optimize(a[1]);
+        });
+        double fft_ns = bench_ns_per_element(n, [&] {
+            a = input;
+            permute(a);
+            fft_butterflies(a);
+            do_not_optimize(a[1]);
+        });
+        std::printf("  %s permute %6.3f fft %7.3f ns/elem%s", name, permute_ns, fft_ns, a == reference ? "" : " (MISMATCH)");
+    };
+    run("naive", naive);
+    run("bit_reversed", incremental);
+    run("fill", batch);
+    std::printf("\n");
+}
+
+int main() {
+    printCompilerInfo();
+    std::printf("\nrangex::for_each<Unroll>() / reduce<Unroll>():\n");
+    bench_unroll<std::uint8_t>("uint8_t", rangex<std::uint8_t>(0, 255, false, 1));
+    bench_unroll<std::int32_t>("int32_t", rangex<std::int32_t>(0, 1 << 24));
+    bench_unroll<std::uint64_t>("uint64_t", rangex<std::uint64_t>(0, 1 << 24));
+    bench_unroll<std::float32_t>("float", rangex<std::float32_t>(scf<32>(0.0f), scf<32>(1.0f), false, scf<32>(1.0f / (1 << 20))));
+    bench_unroll<std::float64_t>("double", rangex<std::float64_t>(scf<64>(0.0), scf<64>(1.0), false, scf<64>(1.0 / (1 << 24))));
+
+    std::printf("\nconcurrent_cursor contention, 2^24 values, %u hardware threads:\n", std::thread::hardware_concurrency());
+    bench_concurrent_cursor("dynamic", schedule_kind::dynamic_chunk, 1);
+    bench_concurrent_cursor("dynamic", schedule_kind::dynamic_chunk, 256);
+    bench_concurrent_cursor("guided", schedule_kind::guided, 256);
+
+    std::printf("\nAll-pairs load balance per worker, row chunks vs balanced_part(triangular_rangex):\n");
+    bench_triangular_balance(4096, 4);
+    bench_triangular_balance(4096, 16);
+    bench_triangular_balance(4096, 64);
+
+    std::printf("\nany_rangex batched dispatch, one indirect call per batch:\n");
+    bench_any_rangex<std::uint16_t, 16384>("uint16_t", rangex<std::uint16_t>(0, 60000));
+    bench_any_rangex<std::int32_t, 256>("int32_t", rangex<std::int32_t>(0, 1 << 22));
+    bench_any_rangex<std::int32_t, 4096>("int32_t", rangex<std::int32_t>(0, 1 << 22));
+    bench_any_rangex<std::int32_t, 16384>("int32_t", rangex<std::int32_t>(0, 1 << 22));
+    bench_any_rangex<std::float32_t, 1024>("float", rangex<std::float32_t>(scf<32>(0.0f), scf<32>(1.0f), false, scf<32>(1.0f / (1 << 22))));
+    bench_any_rangex<std::float64_t, 1024>("double", rangex<std::float64_t>(scf<64>(0.0), scf<64>(1.0), false, scf<64>(1.0 / (1 << 22))));
+
+    std::printf("\nValue to bucket lookups:\n");
+    bench_inverse_queries<std::uint32_t>("uint32_t", rangex<std::uint32_t>(0, 1u << 30, false, 4093), 1 << 20);
+    bench_inverse_queries<std::int32_t>("int32_t", rangex<std::int32_t>(-1000000, 1000000, false, 37), 1 << 20);
+    bench_inverse_queries<std::uint64_t>("uint64_t", rangex<std::uint64_t>(0, 1ull << 31, false, 1000003), 1 << 20);
+    // Values past 2^32 and a step past 2^32: the 64 bit multiply of fast_divider, no hardware divide
+    bench_inverse_queries<std::uint64_t>("uint64_t", rangex<std::uint64_t>(0, 1ull << 40, false, 1000003), 1 << 20);
+    bench_inverse_queries<std::uint64_t>("uint64_t", rangex<std::uint64_t>(1ull << 40, 1ull << 62, false, (1ull << 42) + 7), 1 << 20);
+
+    std::printf("\nHistogram of 2^24 values, kernels picked at run time (naive loop, then each kernel this CPU runs):\n");
+    bench_histogram<float>("float", 64, 1 << 24);
+    bench_histogram<float>("float", 1000, 1 << 24);
+    bench_histogram<float>("float", 16000, 1 << 24);
+    bench_histogram<double>("double", 1000, 1 << 24);
+    bench_histogram<std::int32_t>("int32", 1000, 1 << 24);
+
+    std::printf("\noverflow policy, checks run once in the constructor:\n");
+    bench_overflow_policy<std::int32_t>("int32_t", -(1 << 23), 1 << 23, 1);
+    bench_overflow_policy<std::int64_t>("int64_t", 1ll << 24, 0, -1);
+
+    std::printf("\nparallel_reduce of sin(x), 1e7 values:\n");
+    bench_parallel_reduce(reduce_compensation::none, "none");
+    bench_parallel_reduce(reduce_compensation::kahan, "kahan");
+    bench_parallel_reduce(reduce_compensation::pairwise, "pairwise");
+
+    std::printf("\nresumable_cursor, 20 us slices over 2^24 int32_t:\n");
+    bench_resumable(rangex<std::int32_t>(0, 1 << 24));
+
+    std::printf("\nradix-2 FFT input permutation, naive per-index reversal vs bit_reversed(rangex):\n");
+    bench_fft_bit_reversal(10);
+    bench_fft_bit_reversal(16);
+    bench_fft_bit_reversal(20);
+}
@@ -2,6 +2,7 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <bit>
 #include <iostream>
 
 namespace ns_type_helper {
@@ -72,6 +73,7 @@ namespace std {
 #include <stdfloat>
 #endif
 #include <cmath>
+#include <limits>
 
 namespace ns_type_helper {
 
@@ -200,7 +202,7 @@ struct FloatType<128> {
 
 // Helper function to perform static casting
 template <int Bits, typename U>
-auto scf(U value) -> typename FloatType<Bits>::type {
+constexpr auto scf(U value) -> typename FloatType<Bits>::type {
     return static_cast<typename FloatType<Bits>::type>(value);
 }
 
@@ -208,6 +210,19 @@ auto scf(U value) -> typename FloatType<Bits>::type {
 template <typename T>
 using make_signed_custom_t = typename make_signed_custom<T>::type;
 
+// Type for distances between two values of T: unsigned (and at least unsigned int, so
+// uint8_t / uint16_t arithmetic is not promoted to signed int) for integers, T for floats
+template <typename T, bool = std::is_integral_v<T>>
+struct make_distance {
+    using type = T;
+};
+template <typename T>
+struct make_distance<T, true> {
+    using type = std::conditional_t<(sizeof(T) < sizeof(unsigned)), unsigned, std::make_unsigned_t<T>>;
+};
+template <typename T>
+using make_distance_t = typename make_distance<T>::type;
+
 // compile time check variable type
 template <typename T, typename U>
 constexpr bool check_eq_typeof() {
@@ -232,6 +247,264 @@ constexpr bool check_eq_typeof() {
 //     return 0;
 // }
 
+// std::floor / std::fmod are not constexpr before C++23 (and not at all on some
+// compilers), fall back to plain arithmetic only while constant evaluating
+template <typename T>
+constexpr T constexpr_trunc(T x) {
+    // NaN, inf and values beyond 2^digits are already integral
+    constexpr T integral_limit = static_cast<T>(1) / std::numeric_limits<T>::epsilon();
+    if (!(x < integral_limit && x > -integral_limit)) {
+        return x;
+    }
+    return static_cast<T>(static_cast<long long>(x));
+}
+
+template <typename T>
+constexpr T constexpr_floor(T x) {
+    if (std::is_constant_evaluated()) {
+        T t = constexpr_trunc(x);
+        return t > x ? t - 1 : t;
+    }
+    return std::floor(x);
+}
+
+// Exact IEEE fmod at compile time too, so a constexpr rangex gets the same size() as at run time.
+// Binary long division: subtract |y| * 2^k from |x| for k from the largest that fits down to 0.
+// Doubling and halving |y| are exact, and |x| - s with s <= |x| < 2 * s is exact (Sterbenz)
+template <typename T>
+constexpr T constexpr_fmod(T x, T y) {
+    if (std::is_constant_evaluated()) {
+        if (!(x == x) || !(y == y) || y == 0 || x - x != 0) {
+            // NaN operand, y zero or x infinite
+            return std::numeric_limits<T>::quiet_NaN();
+        }
+        const T ay = y < 0 ? -y : y;
+        T r = x < 0 ? -x : x;
+        if (ay - ay != 0 || r < ay) {
+            // y infinite or |x| < |y|
+            return x;
+        }
+        T s = ay;
+        while (s * 2 <= r) {
+            s *= 2;
+        }
+        while (s >= ay) {
+            if (r >= s) {
+                r -= s;
+            }
+            s /= 2;
+        }
+        return x < 0 ? -r : r;
+    }
+    return std::fmod(x, y);
+}
+
+// floor(sqrt(x)) for every uint64_t: estimate (double at run time, Newton while constant
+// evaluating), then fix the last bit rounding of the estimate with integer arithmetic
+constexpr std::uint64_t isqrt(std::uint64_t x) {
+    std::uint64_t r = 0;
+    if (std::is_constant_evaluated()) {
+        r = x;
+        for (std::uint64_t y = x / 2 + 1; y < r; y = (r + x / r) / 2) {
+            r = y;
+        }
+    } else {
+        r = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(x)));
+    }
+    constexpr std::uint64_t max_root = 0xFFFFFFFFu;
+    r = r > max_root ? max_root : r;
+    while (r * r > x) {
+        r--;
+    }
+    while (r < max_root && (r + 1) * (r + 1) <= x) {
+        r++;
+    }
+    return r;
+}
+
+// out = a - b, returns true when the exact result does not fit in T
+template <typename T>
+constexpr bool sub_overflow(T a, T b, T& out) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_sub_overflow(a, b, &out);
+#else
+    out = static_cast<T>(static_cast<std::make_unsigned_t<T>>(a) - static_cast<std::make_unsigned_t<T>>(b));
+    if constexpr (std::is_unsigned_v<T>) {
+        return a < b;
+    } else {
+        return b < 0 ? a > std::numeric_limits<T>::max() + b : a < std::numeric_limits<T>::min() + b;
+    }
+#endif
+}
+
+// out = a + b, returns true when the exact result does not fit in T
+template <typename T>
+constexpr bool add_overflow(T a, T b, T& out) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(a, b, &out);
+#else
+    out = static_cast<T>(static_cast<std::make_unsigned_t<T>>(a) + static_cast<std::make_unsigned_t<T>>(b));
+    if constexpr (std::is_unsigned_v<T>) {
+        return out < a;
+    } else {
+        return b > 0 ? a > std::numeric_limits<T>::max() - b : a < std::numeric_limits<T>::min() - b;
+    }
+#endif
+}
+
+// out = a * b, returns true when the exact result does not fit in T
+template <typename T>
+constexpr bool mul_overflow(T a, T b, T& out) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_mul_overflow(a, b, &out);
+#else
+    out = static_cast<T>(static_cast<std::make_unsigned_t<T>>(a) * static_cast<std::make_unsigned_t<T>>(b));
+    if (a == 0 || b == 0) {
+        return false;
+    }
+    if constexpr (std::is_unsigned_v<T>) {
+        return out / a != b;
+    } else if (a > 0) {
+        return b > 0 ? a > std::numeric_limits<T>::max() / b : b < std::numeric_limits<T>::min() / a;
+    } else {
+        return b > 0 ? a < std::numeric_limits<T>::min() / b : b < std::numeric_limits<T>::max() / a;
+    }
+#endif
+}
+
+// High 64 bits of a 64 x 64 bit product
+constexpr std::uint64_t mulhi64(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    const std::uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    const std::uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    const std::uint64_t lo_lo = a_lo * b_lo;
+    const std::uint64_t hi_lo = a_hi * b_lo + (lo_lo >> 32);
+    const std::uint64_t lo_hi = a_lo * b_hi + (hi_lo & 0xFFFFFFFFu);
+    return a_hi * b_hi + (hi_lo >> 32) + (lo_hi >> 32);
+#endif
+}
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_bitreverse64)
+#define RANGEX_HAS_BITREVERSE64
+#endif
+#endif
+
+// Bits of x in reverse order, bit 0 becomes bit 63
+constexpr std::uint64_t reverse_bits(std::uint64_t x) {
+#if defined(RANGEX_HAS_BITREVERSE64)
+    return __builtin_bitreverse64(x); // clang, one rbit on ARM
+#else
+#if defined(__GNUC__)
+    x = __builtin_bswap64(x);
+#else
+    x = (x >> 32) | (x << 32);
+    x = ((x >> 16) & 0x0000FFFF0000FFFFull) | ((x & 0x0000FFFF0000FFFFull) << 16);
+    x = ((x >> 8) & 0x00FF00FF00FF00FFull) | ((x & 0x00FF00FF00FF00FFull) << 8);
+#endif
+    // Bytes are in place, reverse the bits inside each byte
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+    x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+    x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+    return x;
+#endif
+}
+
+// n / d with d fixed at construction, plain hardware division
+template <typename U>
+struct plain_divider {
+    U d;
+    constexpr explicit plain_divider(U d_) : d(d_) {}
+    constexpr U div(U n) const {
+        return n / d;
+    }
+};
+
+// n / d with d fixed at construction, for many divisions by the same d, without a branch in div().
+// Unsigned integers up to 32 bits: q = mulhi64(ceil(2^64 / d), n) (Lemire, Kaser, Kurz: Faster
+// Remainder by Direct Computation), a power of two d included; d = 1 takes 2^63 times 2 * n.
+// 64 bits: the libdivide scheme, m = floor(2^(64 + l) / d) + 1 with l = floor(log2(d)) and
+// q = mulhi64(m, n) >> l, or, when that m needs 65 bits, its low 64 bits and
+// q = ((n - t) / 2 + t) >> l with t = mulhi64(m, n) (Granlund, Montgomery: Division by Invariant
+// Integers using Multiplication). A mask picks the add, a power of two d is m = 0 and n >> l.
+// Exact for every n and d != 0, d = 0 gives 0. Wider integers divide in hardware. Floating
+// point: multiply by the reciprocal, the result may be off by one ulp, callers must tolerate that.
+template <typename U, bool = std::is_integral_v<U>>
+class fast_divider {
+public:
+    constexpr explicit fast_divider(U d_)
+        : d(d_) {
+        if (d_ == 0 || sizeof(U) > sizeof(std::uint64_t)) {
+            return;
+        }
+        const std::uint64_t d64 = static_cast<std::uint64_t>(d_);
+        const int l = 63 - std::countl_zero(d64);
+        if constexpr (sizeof(U) <= sizeof(std::uint32_t)) {
+            // ceil(2^64 / d) is 2^64 for d = 1, half of it and n shifted up one instead
+            m = d64 == 1 ? std::uint64_t{1} << 63 : ~std::uint64_t{0} / d64 + 1;
+            shift = d64 == 1 ? 1 : 0;
+        } else if (std::has_single_bit(d64)) {
+            // t = 0, (n + 0) >> l
+            add_mask = ~std::uint64_t{0};
+            shift = static_cast<unsigned char>(l);
+        } else {
+            // 2^(64 + l) = q * d + r by long division, 2^l < d so the quotient fits in 64 bits
+            std::uint64_t r = std::uint64_t{1} << l;
+            std::uint64_t q = 0;
+            for (int bit = 0; bit < 64; ++bit) {
+                const bool carry = r >> 63;
+                r <<= 1;
+                q <<= 1;
+                if (carry || r >= d64) {
+                    r -= d64;
+                    q |= 1;
+                }
+            }
+            shift = static_cast<unsigned char>(l);
+            if (d64 - r < (std::uint64_t{1} << l)) {
+                m = q + 1;
+            } else {
+                // One more bit of precision: 2 * floor(2^(64 + l) / d) rounded, the 65th bit is the add in div()
+                const std::uint64_t twice_r = r + r;
+                m = q + q + (twice_r >= d64 || twice_r < r ? 1 : 0) + 1;
+                halve = 1;
+                add_mask = ~std::uint64_t{0};
+            }
+        }
+    }
+    constexpr U div(U n) const {
+        if constexpr (sizeof(U) <= sizeof(std::uint32_t)) {
+            return static_cast<U>(mulhi64(m, static_cast<std::uint64_t>(n) << shift));
+        } else if constexpr (sizeof(U) <= sizeof(std::uint64_t)) {
+            const std::uint64_t t = mulhi64(m, n);
+            return static_cast<U>(((((n - t) >> halve) & add_mask) + t) >> shift);
+        } else {
+            return n / d;
+        }
+    }
+
+protected:
+    U d;
+    std::uint64_t m = 0;
+    std::uint64_t add_mask = 0;
+    unsigned char halve = 0;
+    unsigned char shift = 0;
+};
+
+template <typename U>
+class fast_divider<U, false> {
+public:
+    constexpr explicit fast_divider(U d_) : inv(static_cast<U>(1) / d_) {}
+    constexpr U div(U n) const {
+        return n * inv;
+    }
+
+protected:
+    U inv;
+};
+
 // compile time choose % or std::fmod
 // Template function to perform modulus operation
 template<typename T>
@@ -240,11 +513,13 @@ constexpr auto std_div_exact(T a, make_signed_custom_t<T> b, T &q) -> bool {
         q = a / b;
         return 0 == a % b; // Use % for integer types
     } else if constexpr (std::is_floating_point_v<T>) {
-        q = static_cast<int>(std::floor(a / b));
+        // Stays in T, a quotient beyond INT_MAX is no undefined conversion
+        q = constexpr_floor(a / b);
         // std::abs not available for std::float128_t
         //return 100 * std::abs(std::fmod(a, b)) < 1; // Use std::fmod for floating-point types
-        return -1 < (10000 * std::fmod(a, b))
-            && (std::fmod(a, b) * 10000) < 1;
+        const T r = constexpr_fmod(a, b);
+        return -1 < (10000 * r)
+            && (r * 10000) < 1;
     } else {
         static_assert(std::is_integral_v<T> || std::is_floating_point_v<T>, "Unsupported type");
     }
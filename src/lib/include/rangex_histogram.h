@@ -0,0 +1,626 @@
+#pragma once
+
+#include "rangex_lib.h"
+
+#include <vector>
+#include <thread>
+#include <span>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+// Kernels compiled for AVX2 / AVX-512 in any build, picked at run time with __builtin_cpu_supports
+#define RANGEX_HISTOGRAM_AVX2
+#define RANGEX_HISTOGRAM_AVX512
+#define RANGEX_TARGET(isa) __attribute__((target(isa)))
+#else
+// No target attribute (MSVC), kernels only for the instruction set of the build
+#if defined(__AVX2__) || defined(__AVX512F__)
+#define RANGEX_HISTOGRAM_AVX2
+#endif
+#if defined(__AVX512F__)
+#define RANGEX_HISTOGRAM_AVX512
+#endif
+#define RANGEX_TARGET(isa)
+#endif
+#endif
+
+namespace ns_rangex {
+
+struct histogram_result {
+    std::vector<std::uint64_t> bins; // edges.size() - 1 bins
+    std::uint64_t underflow = 0;     // before the first edge
+    std::uint64_t overflow = 0;      // at or after the last edge
+    std::uint64_t nan = 0;           // NaN, floating point data only
+
+    histogram_result& operator+=(const histogram_result& other) {
+        for (std::size_t b = 0; b < bins.size() && b < other.bins.size(); ++b) {
+            bins[b] += other.bins[b];
+        }
+        underflow += other.underflow;
+        overflow += other.overflow;
+        nan += other.nan;
+        return *this;
+    }
+};
+
+namespace histogram_detail {
+
+// Counters of one pass: `lanes` private rows of bins + 3 slots (underflow, overflow, NaN),
+// so the lanes of one SIMD batch never increment the same counter
+struct lane_rows {
+    std::size_t bins, stride, lanes;
+    std::vector<std::uint32_t> counts;
+
+    lane_rows(std::size_t bins_, std::size_t lanes_)
+        : bins(bins_)
+        , stride(bins_ + 3)
+        , lanes(lanes_)
+        , counts(stride * lanes_, 0) {
+    }
+    std::uint32_t* row(std::size_t lane) {
+        return counts.data() + lane * stride;
+    }
+    void flush_into(histogram_result& result) {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            const std::uint32_t* r = row(lane);
+            for (std::size_t b = 0; b < bins; ++b) {
+                result.bins[b] += r[b];
+            }
+            result.underflow += r[bins];
+            result.overflow += r[bins + 1];
+            result.nan += r[bins + 2];
+        }
+        std::fill(counts.begin(), counts.end(), 0);
+    }
+};
+
+// Integer edges: the offset from the first edge divided by |step| is the bin, what
+// rangex::upper_bound() computes without its clamping and on-step bookkeeping
+template <typename T>
+struct int_slot_finder {
+    using distance_type = typename rangex<T>::distance_type;
+    fast_divider<distance_type> div;
+    T e0;
+    std::size_t bins;
+    bool ascending;
+    distance_type sign; // 1 or, wrapping, -1
+
+    int_slot_finder(const rangex<T>& edges, std::size_t bins_)
+        : div(edges.divisor())
+        , e0(edges[0])
+        , bins(bins_)
+        , ascending(edges.size() < 2 || edges[0] < edges[1])
+        , sign(ascending ? distance_type{1} : static_cast<distance_type>(~distance_type{0})) {
+    }
+    std::size_t operator()(T v) const {
+        // Both directions and both sides of e0 without a branch: the wrapped offset of a value
+        // below the first edge is dropped by the select at the end
+        const bool below = ascending ? v < e0 : v > e0;
+        const distance_type offset = static_cast<distance_type>(
+            (static_cast<distance_type>(v) - static_cast<distance_type>(e0)) * sign);
+        const distance_type q = div.div(offset);
+        const std::size_t slot = q < bins ? static_cast<std::size_t>(q) : bins + 1;
+        return below ? bins : slot;
+    }
+};
+
+// Bin k holds values from edges[k] (included) to edges[k + 1] (excluded), in iteration order.
+// Slots bins, bins + 1, bins + 2 count underflow, overflow and NaN
+template <typename T>
+struct slot_finder {
+    rangex_lookup<T> lookup;
+    std::size_t bins;
+
+    slot_finder(const rangex<T>& edges, std::size_t bins_)
+        : lookup(edges)
+        , bins(bins_) {
+    }
+    std::size_t operator()(T v) const {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!(v == v)) {
+                return bins + 2;
+            }
+        }
+        const std::size_t after = lookup.upper_bound(v);
+        return 0 == after ? bins : after - 1 < bins ? after - 1 : bins + 1;
+    }
+};
+
+// Floating point edges with every bin number exact in T: one multiply by the reciprocal step
+// and a floor, then one compare against the edges r[k] on each side undoes the rounding of the
+// reciprocal, so bins match rangex::upper_bound() exactly. The compares only run when t lands
+// within a rounding bound of an integer, farther away they cannot change floor(t)
+template <typename T>
+struct float_slot_finder {
+    rangex<T> edges;
+    T e0, inv, top, near_half;
+    std::size_t bins;
+    bool ascending;
+
+    float_slot_finder(const rangex<T>& edges_, std::size_t bins_)
+        : edges(edges_)
+        , e0(edges_[0])
+        , inv(static_cast<T>(1) / edges_.divisor())
+        , top(static_cast<T>(bins_ + 1))
+        , near_half(static_cast<T>(0.5) - rounding_bound(edges_, bins_))
+        , bins(bins_)
+        , ascending(edges_.divisor() > 0) {
+    }
+    // Bound on |t - exact position of v between the edges| for v within one step of the edges:
+    // an ulp each for v - e0, 1 / w, the product and the + 1, plus the rounding of the edge
+    // values, in units of the step and with a factor 2 to spare. 1 (always compare) when not small
+    static T rounding_bound(const rangex<T>& edges, std::size_t bins_) {
+        const T w = std::fabs(edges.divisor());
+        const T span = std::fabs(edges[0]) + std::fabs(edges[bins_]) + 2 * w;
+        const T bound = std::numeric_limits<T>::epsilon() * (5 * (static_cast<T>(bins_) + 2) + span / w);
+        return bound < static_cast<T>(0.25) ? bound : static_cast<T>(1);
+    }
+    std::size_t operator()(T v) const {
+        // Position counted from one bin below the first edge, so it is never negative once
+        // clamped to [0, bins + 1] and the truncating convert is the floor, no libm call.
+        // NaN clamps to 0, lands next to an integer and is sorted out on the rare path below
+        T t = (v - e0) * inv + 1;
+        t = 0 < t ? t : 0;
+        t = t < top ? t : top;
+        const std::int64_t floor_t = static_cast<std::int64_t>(t);
+        if (std::fabs(t - static_cast<T>(floor_t) - static_cast<T>(0.5)) > near_half) [[unlikely]] {
+            return near_edge(v, floor_t - 1);
+        }
+        return to_slot(floor_t - 1);
+    }
+    std::size_t to_slot(std::int64_t k) const {
+        const std::size_t slot = static_cast<std::size_t>(k);
+        return k < 0 ? bins : slot >= bins ? bins + 1 : slot;
+    }
+    // Bin of v next to edge k or k + 1, compared against the edges r[k] themselves
+    std::size_t near_edge(T v, std::int64_t k) const {
+        if (!(v == v)) {
+            return bins + 2;
+        }
+        if (k >= 0 && (ascending ? v < edges[static_cast<std::size_t>(k)] : v > edges[static_cast<std::size_t>(k)])) {
+            k -= 1;
+        } else if (k < static_cast<std::int64_t>(bins)
+            && (ascending ? v >= edges[static_cast<std::size_t>(k + 1)] : v <= edges[static_cast<std::size_t>(k + 1)])) {
+            k += 1;
+        }
+        return to_slot(k);
+    }
+};
+
+template <typename SlotFinder, typename T>
+void count_scalar(SlotFinder slot_of, const T* data, std::size_t n, lane_rows& rows) {
+    // slot_of by value: a local copy stays in registers, the counter stores could alias a reference.
+    // One row, private rows per value measured slower here than the occasional store forwarding stall
+    std::uint32_t* counts = rows.row(0);
+    for (std::size_t i = 0; i < n; ++i) {
+        counts[slot_of(data[i])]++;
+    }
+}
+
+// Instruction set of the counting kernel
+enum class simd_isa {
+    scalar,
+    avx2,
+    avx512,
+};
+
+// Best kernel the running CPU supports
+inline simd_isa detected_isa() {
+#if defined(RANGEX_HISTOGRAM_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    static const simd_isa isa = __builtin_cpu_supports("avx512f") ? simd_isa::avx512
+        : __builtin_cpu_supports("avx2") ? simd_isa::avx2 : simd_isa::scalar;
+    return isa;
+#elif defined(RANGEX_HISTOGRAM_AVX512)
+    return simd_isa::avx512;
+#elif defined(RANGEX_HISTOGRAM_AVX2)
+    return simd_isa::avx2;
+#else
+    return simd_isa::scalar;
+#endif
+}
+
+// Values per vector of the kernel for data of type T, 0 when there is none
+template <typename T>
+constexpr std::size_t kernel_lanes(simd_isa isa) {
+    if (isa == simd_isa::scalar) {
+        return 0;
+    }
+    if constexpr (std::is_same_v<T, float>) {
+        return isa == simd_isa::avx512 ? 16 : 8;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return isa == simd_isa::avx512 ? 8 : 4;
+    } else if constexpr (std::is_same_v<T, std::int32_t>) {
+        return isa == simd_isa::avx512 ? 16 : 8;
+    } else {
+        return 0;
+    }
+}
+
+// Floating point edges for the vector kernels: float_slot_finder and the edges r[k] for every k,
+// filled here through rangex::operator[] in code built for the default target. The kernels
+// compare against these and never compute e0 + k * w themselves, which an AVX-512 target could
+// fuse into an FMA and round differently from r[k]
+template <typename T>
+struct edge_table {
+    float_slot_finder<T> slot_of;
+    std::vector<T> values;
+
+    edge_table(const rangex<T>& edges, std::size_t bins)
+        : slot_of(edges, bins)
+        , values(bins + 1) {
+        for (std::size_t k = 0; k <= bins; ++k) {
+            values[k] = edges[k];
+        }
+    }
+};
+
+// The kernels below are float_slot_finder or, for int32, int_slot_finder for a vector of
+// values, ascending edges only. Lanes where t lands next to an integer gather r[k] and
+// r[k + 1] from the edge_table and compare. Each returns the values consumed, the tail is
+// left to count_scalar(). Lane l counts into private row l, so lanes never increment the
+// same counter
+
+#if defined(RANGEX_HISTOGRAM_AVX2)
+// k < 0 to the underflow slot, k >= bins to the overflow slot
+RANGEX_TARGET("avx2") inline __m256i slots_epi32(__m256i k, __m256i v_bins, __m256i v_over) {
+    const __m256i over = _mm256_cmpeq_epi32(_mm256_max_epu32(k, v_bins), k);
+    return _mm256_blendv_epi8(_mm256_blendv_epi8(k, v_over, over), v_bins, _mm256_cmpgt_epi32(_mm256_setzero_si256(), k));
+}
+RANGEX_TARGET("avx2") inline __m128i slots_epi32(__m128i k, __m128i v_bins, __m128i v_over) {
+    const __m128i over = _mm_cmpeq_epi32(_mm_max_epu32(k, v_bins), k);
+    return _mm_blendv_epi8(_mm_blendv_epi8(k, v_over, over), v_bins, _mm_cmpgt_epi32(_mm_setzero_si128(), k));
+}
+// Low 32 bits of each 64 bit lane, for compare masks of double lanes
+RANGEX_TARGET("avx2") inline __m128i narrow_mask(__m256d mask) {
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(mask), _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)));
+}
+
+RANGEX_TARGET("avx2") inline std::size_t count_avx2(const edge_table<float>& table, const float* data, std::size_t n, lane_rows& rows) {
+    const float_slot_finder<float>& slot_of = table.slot_of;
+    const float* edge = table.values.data();
+    const __m256 v_e0 = _mm256_set1_ps(slot_of.e0), v_inv = _mm256_set1_ps(slot_of.inv), v_top = _mm256_set1_ps(slot_of.top);
+    const __m256 v_near = _mm256_set1_ps(slot_of.near_half), v_half = _mm256_set1_ps(0.5f), v_one = _mm256_set1_ps(1.0f);
+    const __m256 v_zero = _mm256_setzero_ps(), v_abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256i v_bins = _mm256_set1_epi32(static_cast<int>(rows.bins)), v_over = _mm256_set1_epi32(static_cast<int>(rows.bins + 1));
+    const __m256i v_nan = _mm256_set1_epi32(static_cast<int>(rows.bins + 2)), v_one_i = _mm256_set1_epi32(1);
+    alignas(32) std::int32_t slot[8];
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(data + i);
+        // max() returns its second operand for NaN, so NaN lands on 0, next to an integer
+        __m256 t = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(v, v_e0), v_inv), v_one);
+        t = _mm256_min_ps(_mm256_max_ps(t, v_zero), v_top);
+        const __m256 floor_t = _mm256_floor_ps(t);
+        const __m256 frac = _mm256_and_ps(_mm256_sub_ps(_mm256_sub_ps(t, floor_t), v_half), v_abs);
+        const __m256i near = _mm256_castps_si256(_mm256_cmp_ps(frac, v_near, _CMP_GT_OQ));
+        __m256i k = _mm256_sub_epi32(_mm256_cvttps_epi32(floor_t), v_one_i);
+        __m256i slots;
+        if (_mm256_testz_si256(near, near)) [[likely]] {
+            slots = slots_epi32(k, v_bins, v_over);
+        } else {
+            const __m256i has_lo = _mm256_and_si256(near, _mm256_cmpgt_epi32(k, _mm256_set1_epi32(-1)));
+            const __m256i has_hi = _mm256_and_si256(near, _mm256_cmpgt_epi32(v_bins, k));
+            const __m256 lo = _mm256_mask_i32gather_ps(v, edge, k, _mm256_castsi256_ps(has_lo), 4);
+            const __m256 hi = _mm256_mask_i32gather_ps(v, edge, _mm256_add_epi32(k, v_one_i), _mm256_castsi256_ps(has_hi), 4);
+            const __m256i down = _mm256_and_si256(has_lo, _mm256_castps_si256(_mm256_cmp_ps(v, lo, _CMP_LT_OQ)));
+            const __m256i up = _mm256_andnot_si256(down, _mm256_and_si256(has_hi, _mm256_castps_si256(_mm256_cmp_ps(v, hi, _CMP_GE_OQ))));
+            k = _mm256_sub_epi32(_mm256_add_epi32(k, down), up); // masks are -1
+            slots = _mm256_blendv_epi8(slots_epi32(k, v_bins, v_over), v_nan, _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(slot), slots);
+        // No AVX2 scatter, one private row per lane keeps the 8 increments independent
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            rows.row(lane)[slot[lane]]++;
+        }
+    }
+    return i;
+}
+
+RANGEX_TARGET("avx2") inline std::size_t count_avx2(const edge_table<double>& table, const double* data, std::size_t n, lane_rows& rows) {
+    const float_slot_finder<double>& slot_of = table.slot_of;
+    const double* edge = table.values.data();
+    const __m256d v_e0 = _mm256_set1_pd(slot_of.e0), v_inv = _mm256_set1_pd(slot_of.inv), v_top = _mm256_set1_pd(slot_of.top);
+    const __m256d v_near = _mm256_set1_pd(slot_of.near_half), v_half = _mm256_set1_pd(0.5), v_one = _mm256_set1_pd(1.0);
+    const __m256d v_zero = _mm256_setzero_pd(), v_abs = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+    const __m128i v_bins = _mm_set1_epi32(static_cast<int>(rows.bins)), v_over = _mm_set1_epi32(static_cast<int>(rows.bins + 1));
+    const __m128i v_nan = _mm_set1_epi32(static_cast<int>(rows.bins + 2)), v_one_i = _mm_set1_epi32(1);
+    alignas(16) std::int32_t slot[4];
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d v = _mm256_loadu_pd(data + i);
+        __m256d t = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(v, v_e0), v_inv), v_one);
+        t = _mm256_min_pd(_mm256_max_pd(t, v_zero), v_top);
+        const __m256d floor_t = _mm256_floor_pd(t);
+        const __m256d frac = _mm256_and_pd(_mm256_sub_pd(_mm256_sub_pd(t, floor_t), v_half), v_abs);
+        const __m256d near = _mm256_cmp_pd(frac, v_near, _CMP_GT_OQ);
+        __m128i k = _mm_sub_epi32(_mm256_cvttpd_epi32(floor_t), v_one_i);
+        __m128i slots;
+        if (_mm256_testz_pd(near, near)) [[likely]] {
+            slots = slots_epi32(k, v_bins, v_over);
+        } else {
+            const __m128i near_i = narrow_mask(near);
+            const __m128i has_lo = _mm_and_si128(near_i, _mm_cmpgt_epi32(k, _mm_set1_epi32(-1)));
+            const __m128i has_hi = _mm_and_si128(near_i, _mm_cmpgt_epi32(v_bins, k));
+            const __m256d lo = _mm256_mask_i32gather_pd(v, edge, k, _mm256_castsi256_pd(_mm256_cvtepi32_epi64(has_lo)), 8);
+            const __m256d hi = _mm256_mask_i32gather_pd(v, edge, _mm_add_epi32(k, v_one_i), _mm256_castsi256_pd(_mm256_cvtepi32_epi64(has_hi)), 8);
+            const __m128i down = _mm_and_si128(has_lo, narrow_mask(_mm256_cmp_pd(v, lo, _CMP_LT_OQ)));
+            const __m128i up = _mm_andnot_si128(down, _mm_and_si128(has_hi, narrow_mask(_mm256_cmp_pd(v, hi, _CMP_GE_OQ))));
+            k = _mm_sub_epi32(_mm_add_epi32(k, down), up);
+            slots = _mm_blendv_epi8(slots_epi32(k, v_bins, v_over), v_nan, narrow_mask(_mm256_cmp_pd(v, v, _CMP_UNORD_Q)));
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(slot), slots);
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            rows.row(lane)[slot[lane]]++;
+        }
+    }
+    return i;
+}
+
+// int32: the offset from the first edge times the 64 bit magic of fast_divider, high half
+// of the 96 bit product from two 32 x 32 multiplies per lane, exact for any step
+RANGEX_TARGET("avx2") inline __m256i divide_epu32(__m256i n, __m256i m_lo, __m256i m_hi) {
+    // Even lanes in the low halves of the 64 bit elements, odd lanes shifted down into them
+    const __m256i n_odd = _mm256_srli_epi64(n, 32);
+    const __m256i even = _mm256_add_epi64(_mm256_mul_epu32(n, m_hi), _mm256_srli_epi64(_mm256_mul_epu32(n, m_lo), 32));
+    const __m256i odd = _mm256_add_epi64(_mm256_mul_epu32(n_odd, m_hi), _mm256_srli_epi64(_mm256_mul_epu32(n_odd, m_lo), 32));
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+RANGEX_TARGET("avx2") inline std::size_t count_avx2(const rangex<std::int32_t>& edges, const std::int32_t* data, std::size_t n, lane_rows& rows) {
+    const std::uint64_t d = edges.divisor();
+    const std::uint64_t m = d > 1 ? ~std::uint64_t{0} / d + 1 : 0;
+    const int bins = static_cast<int>(rows.bins);
+    const __m256i v_e0 = _mm256_set1_epi32(edges[0]), v_bins = _mm256_set1_epi32(bins);
+    const __m256i v_m_lo = _mm256_set1_epi64x(static_cast<long long>(m & 0xFFFFFFFFu));
+    const __m256i v_m_hi = _mm256_set1_epi64x(static_cast<long long>(m >> 32));
+    const __m256i v_over = _mm256_set1_epi32(bins + 1);
+    alignas(32) std::int32_t slot[8];
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i below = _mm256_cmpgt_epi32(v_e0, v);
+        const __m256i offset = _mm256_sub_epi32(v, v_e0); // wraps for values below e0, dropped by the last blend
+        const __m256i q = m ? divide_epu32(offset, v_m_lo, v_m_hi) : offset;
+        const __m256i over = _mm256_cmpeq_epi32(_mm256_max_epu32(q, v_bins), q);
+        __m256i k = _mm256_blendv_epi8(q, v_over, over);
+        k = _mm256_blendv_epi8(k, v_bins, below);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(slot), k);
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            rows.row(lane)[slot[lane]]++;
+        }
+    }
+    return i;
+}
+#endif
+
+#if defined(RANGEX_HISTOGRAM_AVX512)
+RANGEX_TARGET("avx512f") inline std::size_t count_avx512(const edge_table<float>& table, const float* data, std::size_t n, lane_rows& rows) {
+    const float_slot_finder<float>& slot_of = table.slot_of;
+    const float* edge = table.values.data();
+    const __m512 v_e0 = _mm512_set1_ps(slot_of.e0), v_inv = _mm512_set1_ps(slot_of.inv), v_top = _mm512_set1_ps(slot_of.top);
+    const __m512 v_near = _mm512_set1_ps(slot_of.near_half), v_half = _mm512_set1_ps(0.5f), v_one = _mm512_set1_ps(1.0f);
+    const __m512 v_zero = _mm512_setzero_ps();
+    const __m512i v_bins = _mm512_set1_epi32(static_cast<int>(rows.bins)), v_over = _mm512_set1_epi32(static_cast<int>(rows.bins + 1));
+    const __m512i v_one_i = _mm512_set1_epi32(1), v_zero_i = _mm512_setzero_si512();
+    const __m512i v_row_base = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+        _mm512_set1_epi32(static_cast<int>(rows.stride)));
+    int* counts = reinterpret_cast<int*>(rows.counts.data());
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512 v = _mm512_loadu_ps(data + i);
+        __m512 t = _mm512_add_ps(_mm512_mul_ps(_mm512_sub_ps(v, v_e0), v_inv), v_one);
+        t = _mm512_min_ps(_mm512_max_ps(t, v_zero), v_top);
+        const __m512 floor_t = _mm512_roundscale_ps(t, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        const __m512 frac = _mm512_abs_ps(_mm512_sub_ps(_mm512_sub_ps(t, floor_t), v_half));
+        const __mmask16 near = _mm512_cmp_ps_mask(frac, v_near, _CMP_GT_OQ);
+        __m512i k = _mm512_sub_epi32(_mm512_cvttps_epi32(floor_t), v_one_i);
+        __mmask16 nan = 0;
+        if (near) [[unlikely]] {
+            const __mmask16 has_lo = _mm512_mask_cmpge_epi32_mask(near, k, v_zero_i);
+            const __mmask16 has_hi = _mm512_mask_cmplt_epi32_mask(near, k, v_bins);
+            const __m512 lo = _mm512_mask_i32gather_ps(v, has_lo, k, edge, 4);
+            const __m512 hi = _mm512_mask_i32gather_ps(v, has_hi, _mm512_add_epi32(k, v_one_i), edge, 4);
+            const __mmask16 down = _mm512_mask_cmp_ps_mask(has_lo, v, lo, _CMP_LT_OQ);
+            const __mmask16 up = _mm512_mask_cmp_ps_mask(has_hi & static_cast<__mmask16>(~down), v, hi, _CMP_GE_OQ);
+            k = _mm512_mask_sub_epi32(k, down, k, v_one_i);
+            k = _mm512_mask_add_epi32(k, up, k, v_one_i);
+            nan = _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q);
+        }
+        __m512i slots = _mm512_mask_blend_epi32(_mm512_cmpge_epu32_mask(k, v_bins), k, v_over);
+        slots = _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(k, v_zero_i), slots, v_bins);
+        slots = _mm512_mask_blend_epi32(nan, slots, _mm512_set1_epi32(static_cast<int>(rows.bins + 2)));
+        // Gather, add, scatter: lanes hit different rows, so there is no scatter conflict
+        const __m512i index = _mm512_add_epi32(v_row_base, slots);
+        const __m512i c = _mm512_i32gather_epi32(index, counts, 4);
+        _mm512_i32scatter_epi32(counts, index, _mm512_add_epi32(c, v_one_i), 4);
+    }
+    return i;
+}
+
+RANGEX_TARGET("avx512f") inline std::size_t count_avx512(const edge_table<double>& table, const double* data, std::size_t n, lane_rows& rows) {
+    const float_slot_finder<double>& slot_of = table.slot_of;
+    const double* edge = table.values.data();
+    const __m512d v_e0 = _mm512_set1_pd(slot_of.e0), v_inv = _mm512_set1_pd(slot_of.inv), v_top = _mm512_set1_pd(slot_of.top);
+    const __m512d v_near = _mm512_set1_pd(slot_of.near_half), v_half = _mm512_set1_pd(0.5), v_one = _mm512_set1_pd(1.0);
+    const __m512d v_zero = _mm512_setzero_pd(), v_bins_d = _mm512_set1_pd(static_cast<double>(rows.bins));
+    const __m256i v_bins = _mm256_set1_epi32(static_cast<int>(rows.bins)), v_over = _mm256_set1_epi32(static_cast<int>(rows.bins + 1));
+    const __m256i v_one_i = _mm256_set1_epi32(1);
+    alignas(32) std::int32_t slot[8];
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m512d v = _mm512_loadu_pd(data + i);
+        __m512d t = _mm512_add_pd(_mm512_mul_pd(_mm512_sub_pd(v, v_e0), v_inv), v_one);
+        t = _mm512_min_pd(_mm512_max_pd(t, v_zero), v_top);
+        const __m512d floor_t = _mm512_roundscale_pd(t, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        const __m512d frac = _mm512_abs_pd(_mm512_sub_pd(_mm512_sub_pd(t, floor_t), v_half));
+        const __mmask8 near = _mm512_cmp_pd_mask(frac, v_near, _CMP_GT_OQ);
+        __m512d k_d = _mm512_sub_pd(floor_t, v_one);
+        __m256i k = _mm512_cvttpd_epi32(k_d);
+        __m256i slots;
+        if (near) [[unlikely]] {
+            // Bin arithmetic in double lanes, the mask forms of the int32 compares need AVX-512VL
+            const __mmask8 has_lo = _mm512_mask_cmp_pd_mask(near, k_d, v_zero, _CMP_GE_OQ);
+            const __mmask8 has_hi = _mm512_mask_cmp_pd_mask(near, k_d, v_bins_d, _CMP_LT_OQ);
+            const __m512d lo = _mm512_mask_i32gather_pd(v, has_lo, k, edge, 8);
+            const __m512d hi = _mm512_mask_i32gather_pd(v, has_hi, _mm256_add_epi32(k, v_one_i), edge, 8);
+            const __mmask8 down = _mm512_mask_cmp_pd_mask(has_lo, v, lo, _CMP_LT_OQ);
+            const __mmask8 up = _mm512_mask_cmp_pd_mask(has_hi & static_cast<__mmask8>(~down), v, hi, _CMP_GE_OQ);
+            k_d = _mm512_mask_sub_pd(k_d, down, k_d, v_one);
+            k_d = _mm512_mask_add_pd(k_d, up, k_d, v_one);
+            __m512d slot_d = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(k_d, v_zero, _CMP_LT_OQ), k_d, v_bins_d);
+            slot_d = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(k_d, v_bins_d, _CMP_GE_OQ), slot_d, _mm512_set1_pd(static_cast<double>(rows.bins + 1)));
+            slot_d = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(v, v, _CMP_UNORD_Q), slot_d, _mm512_set1_pd(static_cast<double>(rows.bins + 2)));
+            slots = _mm512_cvttpd_epi32(slot_d);
+        } else {
+            slots = slots_epi32(k, v_bins, v_over);
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(slot), slots);
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            rows.row(lane)[slot[lane]]++;
+        }
+    }
+    return i;
+}
+
+RANGEX_TARGET("avx512f") inline __m512i divide_epu32(__m512i n, __m512i m_lo, __m512i m_hi) {
+    const __m512i n_odd = _mm512_srli_epi64(n, 32);
+    const __m512i even = _mm512_add_epi64(_mm512_mul_epu32(n, m_hi), _mm512_srli_epi64(_mm512_mul_epu32(n, m_lo), 32));
+    const __m512i odd = _mm512_add_epi64(_mm512_mul_epu32(n_odd, m_hi), _mm512_srli_epi64(_mm512_mul_epu32(n_odd, m_lo), 32));
+    return _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+}
+
+RANGEX_TARGET("avx512f") inline std::size_t count_avx512(const rangex<std::int32_t>& edges, const std::int32_t* data, std::size_t n, lane_rows& rows) {
+    const std::uint64_t d = edges.divisor();
+    const std::uint64_t m = d > 1 ? ~std::uint64_t{0} / d + 1 : 0;
+    const int bins = static_cast<int>(rows.bins);
+    const __m512i v_e0 = _mm512_set1_epi32(edges[0]), v_bins = _mm512_set1_epi32(bins);
+    const __m512i v_m_lo = _mm512_set1_epi64(static_cast<long long>(m & 0xFFFFFFFFu));
+    const __m512i v_m_hi = _mm512_set1_epi64(static_cast<long long>(m >> 32));
+    const __m512i v_row_base = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+        _mm512_set1_epi32(static_cast<int>(rows.stride)));
+    const __m512i v_inc = _mm512_set1_epi32(1);
+    int* counts = reinterpret_cast<int*>(rows.counts.data());
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i v = _mm512_loadu_si512(data + i);
+        const __m512i offset = _mm512_sub_epi32(v, v_e0);
+        const __m512i q = m ? divide_epu32(offset, v_m_lo, v_m_hi) : offset;
+        __m512i k = _mm512_mask_blend_epi32(_mm512_cmpge_epu32_mask(q, v_bins), q, _mm512_set1_epi32(bins + 1));
+        k = _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(v, v_e0), k, v_bins);
+        const __m512i index = _mm512_add_epi32(v_row_base, k);
+        const __m512i c = _mm512_i32gather_epi32(index, counts, 4);
+        _mm512_i32scatter_epi32(counts, index, _mm512_add_epi32(c, v_inc), 4);
+    }
+    return i;
+}
+#endif
+
+// Runs the vector kernel of `isa` on edges, a rangex<int32_t> or an edge_table
+template <typename Edges, typename T>
+std::size_t count_kernel([[maybe_unused]] simd_isa isa, [[maybe_unused]] const Edges& edges,
+    [[maybe_unused]] const T* data, [[maybe_unused]] std::size_t n, [[maybe_unused]] lane_rows& rows) {
+#if defined(RANGEX_HISTOGRAM_AVX512)
+    if (isa == simd_isa::avx512) {
+        return count_avx512(edges, data, n, rows);
+    }
+#endif
+#if defined(RANGEX_HISTOGRAM_AVX2)
+    if (isa == simd_isa::avx2 || isa == simd_isa::avx512) {
+        return count_avx2(edges, data, n, rows);
+    }
+#endif
+    return 0;
+}
+
+// Values the vector kernel of `isa` consumed, 0 when it does not apply to these edges
+template <typename T>
+std::size_t count_simd([[maybe_unused]] simd_isa isa, [[maybe_unused]] const rangex<T>& edges,
+    [[maybe_unused]] const T* data, [[maybe_unused]] std::size_t n, [[maybe_unused]] lane_rows& rows) {
+    if constexpr (kernel_lanes<T>(simd_isa::avx2) > 0) {
+        const std::size_t bins = rows.bins;
+        // Bin numbers exact in the vector element type (int32 lanes for integers), ascending edges
+        constexpr std::size_t exact_bins = std::size_t{1} << (std::is_same_v<T, float> ? 24 : std::is_same_v<T, double> ? 52 : 30);
+        if (bins == 0 || bins >= exact_bins || rows.lanes < kernel_lanes<T>(isa) || !(edges[0] < edges[1])) {
+            return 0;
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            return count_kernel(isa, edge_table<T>(edges, bins), data, n, rows);
+        } else {
+            return count_kernel(isa, edges, data, n, rows);
+        }
+    }
+    return 0;
+}
+
+// Single threaded histogram of data into result, which must have edges.size() - 1 bins
+template <typename T>
+void count_into(const rangex<T>& edges, std::span<const T> data, histogram_result& result, simd_isa isa = detected_isa()) {
+    const std::size_t bins = result.bins.size();
+    // One private row per vector lane, they only pay off while they stay in cache
+    const std::size_t lanes = bins <= (std::size_t{1} << 14) ? std::max<std::size_t>(1, kernel_lanes<T>(isa)) : 1;
+    lane_rows rows(bins, lanes);
+    // uint32 lane counters, flush before any of them can wrap
+    constexpr std::size_t block = std::size_t{1} << 31;
+    for (std::size_t first = 0; first < data.size(); first += block) {
+        const T* p = data.data() + first;
+        const std::size_t n = std::min(block, data.size() - first);
+        const std::size_t done = count_simd(isa, edges, p, n, rows);
+        if constexpr (std::is_floating_point_v<T>) {
+            if (bins > 0 && bins < (std::size_t{1} << (std::numeric_limits<T>::digits - 1))) {
+                count_scalar(float_slot_finder<T>(edges, bins), p + done, n - done, rows);
+            } else {
+                count_scalar(slot_finder<T>(edges, bins), p + done, n - done, rows);
+            }
+        } else if (bins > 0) {
+            count_scalar(int_slot_finder<T>(edges, bins), p + done, n - done, rows);
+        } else {
+            count_scalar(slot_finder<T>(edges, bins), p + done, n - done, rows);
+        }
+        rows.flush_into(result);
+    }
+}
+
+} // namespace histogram_detail
+
+/// Counts of data over uniform bins whose edges are the values of a rangex:
+/// auto h = histogram(rangex<float>(0.0f, 100.0f, true, 0.5f), std::span<const float>(samples));
+/// Bin k holds values from edges[k] (included) to edges[k + 1] (excluded), in iteration order,
+/// anything else goes to underflow / overflow / nan. Bin numbers come from the closed form
+/// inverse of the rangex (see rangex::upper_bound()), vectorized for float, double and int32 data
+/// with AVX2 or AVX-512 when the running CPU has them (chosen at run time, no build flags needed).
+/// threads > 1 counts equal parts of data on their own threads, then adds up.
+template <typename T>
+histogram_result histogram(const rangex<T>& edges, std::span<const T> data, std::size_t threads = 1) {
+    histogram_result result;
+    result.bins.assign(edges.size() > 1 ? edges.size() - 1 : 0, 0);
+    if (threads <= 1 || data.size() < threads) {
+        histogram_detail::count_into(edges, data, result);
+        return result;
+    }
+    std::vector<histogram_result> partial(threads, result);
+    std::vector<std::thread> workers;
+    const auto indices = rangex<std::size_t>(0, data.size());
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&edges, &data, &partial, &indices, threads, t] {
+            const auto part = balanced_part(indices, threads, t);
+            if (!part.empty()) {
+                histogram_detail::count_into(edges, data.subspan(part[0], part.size()), partial[t]);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    for (const auto& p : partial) {
+        result += p;
+    }
+    return result;
+}
+
+} // namespace ns_rangex
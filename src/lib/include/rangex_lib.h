@@ -9,8 +9,17 @@
 #include "cstdtype_helper.h"
 using namespace ns_type_helper;
 
-#include <variant>
 #include <iostream>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <array>
+#include <stdexcept>
+#include <span>
+#include <new>
+#include <optional>
+#include <bit>
+#include <cmath>
 
 namespace ns_rangex {
 
@@ -31,30 +40,40 @@ namespace ns_rangex {
 /// 
 ///```
 
-template <typename T = int, bool IncludeIndex = false, bool DebugPrint = false>
+/// What the constructor of a rangex rejects. The integer trip count is always
+/// |end - start| / |step| computed in the unsigned distance type, exact for any start and end
+enum class overflow_policy {
+    unchecked, // no checks, a trip count beyond std::size_t wraps (every value of uint64_t gives size() 0)
+               // or, for floating point, saturates at the std::size_t maximum
+    checked,   // throws std::overflow_error when end - start (in step direction) overflows T
+               // or the trip count does not fit in std::size_t
+    widen,     // accepts any start and end of T, throws std::overflow_error only when
+               // the trip count does not fit in std::size_t
+};
+/// rangex<int8_t>(-100, 100) => 200 values under unchecked and widen,
+/// rangex<int8_t, false, false, overflow_policy::checked>(-100, 100) throws.
+/// Floating point ranges compute the trip count in T under every policy, checked and widen
+/// both throw std::overflow_error when it does not fit in std::size_t.
+/// All the checking happens in the constructor, the loop itself is the same for every policy.
+
+template <typename T = int, bool IncludeIndex = false, bool DebugPrint = false, overflow_policy Overflow = overflow_policy::unchecked>
 class rangex {
 public:
 using signed_step_type_t = make_signed_custom_t<T>;
+using value_type = std::conditional_t<IncludeIndex, std::pair<std::size_t, T>, T>;
+using distance_type = make_distance_t<T>;
     struct iterator {
     public:
         using value_type = std::conditional_t<IncludeIndex, std::pair<std::size_t, T>, T>;
-        // Initialize index only if IncludeIndex is true
-        auto initialize_index() const {
-            if constexpr (IncludeIndex) {
-                return std::size_t{0};
-            } else {
-                return std::monostate{};
-            }
-        }
         // Iterator constructor
-        iterator(T value_, signed_step_type_t step_)
+        constexpr iterator(T value_, signed_step_type_t step_, std::size_t index_ = 0)
             : value(value_)
             , step(step_)
-            , _index(initialize_index()) // , _index(0)
+            , _index(index_)
         {
         }
         // Dereference operator to return the current value
-        value_type operator*() const {
+        constexpr value_type operator*() const {
             if constexpr (IncludeIndex) {
                 return { _index, value };
             }
@@ -63,29 +82,34 @@ using signed_step_type_t = make_signed_custom_t<T>;
             }
         }
         // Prefix increment operator to move to the next value
-        iterator& operator++() {
-            value += step; // Increment value by step
-            if constexpr (IncludeIndex) {
-                _index++;
+        constexpr iterator& operator++() {
+            if constexpr (std::is_integral_v<T>) {
+                // Wrap in unsigned arithmetic, the step past the last value may leave T
+                value = static_cast<T>(static_cast<distance_type>(value) + static_cast<distance_type>(step));
+            } else {
+                value += step; // Increment value by step
             }
+            _index++;
             return *this;
         }
         // Comparison operator to check if two iterators are not equal
-        bool operator!=(const iterator& other) const {
-            //std::printf("loop condition: %d %d\n", value, other.value);
-            return value != other.value; // Check if the current value is not equal to end value
+        constexpr bool operator!=(const iterator& other) const {
+            // Compare trip index, not value: accumulated float rounding of `value += step`
+            // must not step over the end of a range (or of a subrange())
+            return _index != other._index;
         }
 
     protected:
         T value; // Current value
         signed_step_type_t step;  // Step size
-        std::conditional_t<IncludeIndex, std::size_t, std::monostate> _index; //std::size_t _index;
+        std::size_t _index; // Trip index, also the index of an indexed range
     };
 
-    rangex(T start_, T end_, bool inclusive = false, signed_step_type_t step_ = 1)
+    constexpr rangex(T start_, T end_, bool inclusive = false, signed_step_type_t step_ = 1)
         : start(start_)
         //, _end(end)
-        , step(step_) {
+        , step(step_)
+        , _size(0) {
         if ((start_ <= end_ && step_ < 0)
             || (start_ >= end_ && step_ > 0)
            ) {
@@ -93,24 +117,67 @@ using signed_step_type_t = make_signed_custom_t<T>;
         }
         else if (0 == step_) {
             // throw exception or allow possible infinity loop call next() if start != end?
+            // size() stays 0, so the loop does nothing instead of spinning on a zero step
             this->_end = end_;
         }
+        else if constexpr (std::is_integral_v<T>) {
+            // Distance in step direction is never negative, so it fits the unsigned distance type
+            const distance_type span = step_ > 0
+                ? static_cast<distance_type>(static_cast<distance_type>(end_) - static_cast<distance_type>(start_))
+                : static_cast<distance_type>(static_cast<distance_type>(start_) - static_cast<distance_type>(end_));
+            if constexpr (Overflow == overflow_policy::checked) {
+                T rangex_size{};
+                if (step_ > 0 ? sub_overflow(end_, start_, rangex_size) : sub_overflow(start_, end_, rangex_size)) {
+                    throw std::overflow_error("rangex: end - start overflows the element type");
+                }
+            }
+            const distance_type d = divisor();
+            const distance_type num_steps = span / d;
+            const bool exactly_on_step = 0 == span - num_steps * d;
+            // Trip count is num_steps + 1 for e.g. every value of uint64_t, one more than size_t holds
+            bool too_many = add_overflow(static_cast<std::size_t>(num_steps),
+                std::size_t{!exactly_on_step || inclusive ? 1u : 0u}, this->_size);
+            if constexpr (sizeof(distance_type) > sizeof(std::size_t)) {
+                too_many = too_many || num_steps > std::numeric_limits<std::size_t>::max();
+            }
+            if constexpr (Overflow != overflow_policy::unchecked) {
+                if (too_many) {
+                    throw std::overflow_error("rangex: trip count overflows std::size_t");
+                }
+            }
+            this->_end = advance(start_, this->_size);
+            if constexpr (DebugPrint) {
+                std::cout << "Range size:" << +span << " num steps:" << +num_steps << " on step:" << exactly_on_step << std::endl;
+                std::cout << "Start:" << +start << " end:" << +_end << std::endl;
+            }
+        }
         else {
             // Calculate padding based on step direction
             T rangex_size = end_ - start;
-            T num_steps;
+            T num_steps{};
             bool exactly_on_step = std_div_exact(rangex_size, step, num_steps);
             if constexpr (DebugPrint) {
                 std::cout << "Range size:" << rangex_size << " num steps:" << num_steps << " on step:" << exactly_on_step << std::endl;
             }
             // Align `end` based on last multiple of `step` in rangex
             this->_end = start + (num_steps * step);
-            if (!exactly_on_step) {
+            const bool one_more = !exactly_on_step || inclusive;
+            if (one_more) {
+                // If inclusive, add one more `step` to include the endpoint
                 this->_end += step;
             }
-            // If inclusive, add one more `step` to include the endpoint
-            if (inclusive && exactly_on_step) {
-                this->_end += step;
+            // 2^64 (for a 64 bit size_t) is exact in every floating point type, NaN and inf fail the compare too
+            constexpr T size_limit = static_cast<T>(std::numeric_limits<std::size_t>::max() / 2 + 1) * 2;
+            bool too_many = !(num_steps < size_limit);
+            if (!too_many) {
+                too_many = add_overflow(static_cast<std::size_t>(num_steps), std::size_t{one_more ? 1u : 0u}, this->_size);
+            }
+            if (too_many) {
+                if constexpr (Overflow != overflow_policy::unchecked) {
+                    throw std::overflow_error("rangex: trip count overflows std::size_t");
+                }
+                // Saturates, the trip count is no integer a wrap could be taken of
+                this->_size = std::numeric_limits<std::size_t>::max();
             }
 
             if constexpr (DebugPrint) {
@@ -119,18 +186,751 @@ using signed_step_type_t = make_signed_custom_t<T>;
         }
     };
     // Begin method for rangex-based for loop
-    iterator begin() const {
-        return iterator(start, step);
+    constexpr iterator begin() const {
+        return iterator(start, step, 0);
     }
     // End method for rangex-based for loop
-    iterator end() const {
-        return iterator(_end, step);
+    constexpr iterator end() const {
+        return iterator(_end, step, _size);
+    }
+
+    // Trip count, number of values the loop will produce
+    constexpr std::size_t size() const {
+        return _size;
+    }
+    constexpr bool empty() const {
+        return 0 == _size;
+    }
+    // k-th value computed as start + k * step, no dependency on the previous value.
+    // For floats not always the k-th value of a range-for, which accumulates `value += step`
+    constexpr value_type operator[](std::size_t k) const {
+        return make_value(k, value_at(k));
+    }
+
+    // Values [first, first + count) as a rangex of their own, clamped to size()
+    constexpr rangex subrange(std::size_t first, std::size_t count) const {
+        rangex r = *this;
+        first = std::min(first, _size);
+        r._size = std::min(count, _size - first);
+        r.start = value_at(first);
+        r._end = advance(r.start, r._size);
+        return r;
+    }
+
+    // Write values [first, first + count) to out, clamped to size(), returns the number written.
+    // Plain indexed stores without a loop carried value, so the compiler can vectorize it
+    constexpr std::size_t fill(std::size_t first, T* out, std::size_t count) const {
+        first = std::min(first, _size);
+        count = std::min(count, _size - first);
+        if constexpr (std::is_floating_point_v<T>) {
+            // Every lane is r[first + k], so values do not depend on where a batch starts.
+            // An int32 lane index converts with one packed instruction (int64 needs AVX-512)
+            // and rounds the same integer to the same T as value_at()
+            const std::size_t last = first + count;
+            if (last <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+                const auto from = static_cast<std::int32_t>(first);
+                const auto n = static_cast<std::int32_t>(count);
+                for (std::int32_t k = 0; k < n; ++k) {
+                    out[k] = static_cast<T>(start + static_cast<T>(from + k) * step);
+                }
+            } else {
+                for (std::size_t k = 0; k < count; ++k) {
+                    out[k] = value_at(first + k);
+                }
+            }
+        } else {
+            const T base = value_at(first);
+            for (std::size_t k = 0; k < count; ++k) {
+                out[k] = advance(base, k);
+            }
+        }
+        return count;
+    }
+
+    /// O(1) inverse queries, the position of a value instead of a std::find() over the values.
+    /// "Before" / "after" follow the iteration order, so they flip for a negative step.
+    /// Floats are matched against r[k] = start + k * step, which may differ in the last bits
+    /// from the value reached by repeated `value += step` in a range-for.
+    // v is one of the values
+    constexpr bool contains(T v) const {
+        return contains(v, plain_divider<distance_type>(divisor()));
+    }
+    // k with r[k] == v
+    constexpr std::optional<std::size_t> index_of(T v) const {
+        return index_of(v, plain_divider<distance_type>(divisor()));
+    }
+    // First k where r[k] is not before v, size() if there is none
+    constexpr std::size_t lower_bound(T v) const {
+        return lower_bound(v, plain_divider<distance_type>(divisor()));
+    }
+    // First k where r[k] is after v, size() if there is none
+    constexpr std::size_t upper_bound(T v) const {
+        return upper_bound(v, plain_divider<distance_type>(divisor()));
+    }
+    // Nearest value (ties go to the later one), values outside snap to the first / last value.
+    // An empty range returns its start
+    constexpr T clamp_to_grid(T v) const {
+        return clamp_to_grid(v, plain_divider<distance_type>(divisor()));
+    }
+
+    // Same queries with the division by the step done by `div`, see rangex_lookup
+    template <typename Divider>
+    constexpr bool contains(T v, const Divider& div) const {
+        const grid_position p = locate(v, div);
+        return !p.before && p.on_step && p.index < _size;
+    }
+    template <typename Divider>
+    constexpr std::optional<std::size_t> index_of(T v, const Divider& div) const {
+        const grid_position p = locate(v, div);
+        if (!p.before && p.on_step && p.index < _size) {
+            return p.index;
+        }
+        return std::nullopt;
+    }
+    template <typename Divider>
+    constexpr std::size_t lower_bound(T v, const Divider& div) const {
+        const grid_position p = locate(v, div);
+        return p.before ? 0 : std::min(_size, p.index + (p.on_step ? 0 : 1));
+    }
+    template <typename Divider>
+    constexpr std::size_t upper_bound(T v, const Divider& div) const {
+        const grid_position p = locate(v, div);
+        return p.before ? 0 : std::min(_size, p.index + 1);
+    }
+    template <typename Divider>
+    constexpr T clamp_to_grid(T v, const Divider& div) const {
+        const grid_position p = locate(v, div);
+        if (p.before || 0 == _size) {
+            return start;
+        }
+        return value_at(std::min(_size - 1, p.index + (p.nearer_next ? 1 : 0)));
+    }
+    // What the queries divide by: |step| as distance_type for integers, step for floats
+    constexpr distance_type divisor() const {
+        if constexpr (std::is_integral_v<T>) {
+            return step > 0 ? static_cast<distance_type>(step) : distance_type{0} - static_cast<distance_type>(step);
+        } else {
+            return step;
+        }
+    }
+
+    /// Unrolled loop with visible trip count:
+    /// r.for_each<8>([&](auto v) { ... });
+    /// =>
+    /// for(k = 0; k + 8 <= size; k += 8) { fn(r[k]); fn(r[k + 1]); ... fn(r[k + 7]); }
+    /// for(; k < size; ++k) { fn(r[k]); } // remainder
+    /// Floats: r[k] is start + k * step, a range-for accumulates `value += step` instead, the two
+    /// differ in the last bits for most k of e.g. rangex<float>(0.0f, 100.0f, false, 0.1f)
+    template <std::size_t Unroll = 4, typename Fn>
+    constexpr void for_each(Fn&& fn) const {
+        for_each_n<Unroll>(_size, std::forward<Fn>(fn));
+    }
+    // Same as for_each() on the first n values only, n is clamped to size(), r[k] for floats too
+    template <std::size_t Unroll = 4, typename Fn>
+    constexpr void for_each_n(std::size_t n, Fn&& fn) const {
+        static_assert(Unroll > 0, "Unroll must be at least 1");
+        n = std::min(n, _size);
+        const std::size_t main_trips = n - n % Unroll;
+        std::size_t k = 0;
+        for (; k < main_trips; k += Unroll) {
+            // Every lane is r[k + U] on its own, so the values do not depend on Unroll
+            [&]<std::size_t... U>(std::index_sequence<U...>) {
+                (fn(make_value(k + U, value_at(k + U))), ...);
+            }(std::make_index_sequence<Unroll>{});
+        }
+        for (; k < n; ++k) {
+            fn((*this)[k]);
+        }
+    }
+
+    /// Fold all values with Unroll independent partial accumulators, which breaks the
+    /// loop carried dependency of e.g. a float sum. Each lane starts at `identity` and folds its
+    /// values with op(Acc, T), then the lanes are folded into init with combine(Acc, Acc):
+    /// auto sum = rangex<float>(0.0f, 1.0f, false, 0.001f).reduce<8>(0.0f);
+    /// auto squares = r.reduce<4>(0, [](int a, int v) { return a + v * v; });
+    /// auto product = r.reduce<4>(1, std::multiplies<>{}, std::multiplies<>{}, 1);
+    /// Unroll 1 (or fewer values than Unroll) is the plain sequential op(op(init, r[0]), r[1]) ...
+    /// Note: for floats the result may differ in the last bits from a sequential sum, and the
+    /// values folded are r[k] = start + k * step, not the accumulated values of a range-for
+    template <std::size_t Unroll = 4, typename Acc, typename Op = std::plus<>, typename Combine = std::plus<>>
+    constexpr Acc reduce(Acc init, Op op = {}, Combine combine = {}, Acc identity = Acc{}) const {
+        static_assert(Unroll > 0, "Unroll must be at least 1");
+        if (Unroll == 1 || _size < Unroll) {
+            for (std::size_t k = 0; k < _size; ++k) {
+                init = op(init, value_at(k));
+            }
+            return init;
+        }
+        Acc partial[Unroll];
+        for (std::size_t u = 0; u < Unroll; ++u) {
+            partial[u] = identity;
+        }
+        const std::size_t main_trips = _size - _size % Unroll;
+        std::size_t k = 0;
+        for (; k < main_trips; k += Unroll) {
+            [&]<std::size_t... U>(std::index_sequence<U...>) {
+                ((partial[U] = op(partial[U], value_at(k + U))), ...);
+            }(std::make_index_sequence<Unroll>{});
+        }
+        for (; k < _size; ++k) {
+            partial[k % Unroll] = op(partial[k % Unroll], value_at(k));
+        }
+        for (std::size_t u = 0; u < Unroll; ++u) {
+            init = combine(init, partial[u]);
+        }
+        return init;
     }
 
 protected:
+    // base + k * step
+    constexpr T advance(T base, std::size_t k) const {
+        if constexpr (std::is_integral_v<T>) {
+            // Wrap around in unsigned arithmetic, same as repeated `value += step` does
+            // for a descending uint8_t
+            return static_cast<T>(static_cast<distance_type>(base) + static_cast<distance_type>(k) * static_cast<distance_type>(step));
+        } else {
+            // Signed convert is a single instruction, size_t to float is not on x86-64
+            return static_cast<T>(base + static_cast<T>(static_cast<std::int64_t>(k)) * step);
+        }
+    }
+    constexpr T value_at(std::size_t k) const {
+        return advance(start, k);
+    }
+
+    // Where v falls on the grid start + k * step, k unbounded above
+    struct grid_position {
+        bool before;      // v comes before start
+        std::size_t index; // last k whose value is not after v, capped at size()
+        bool on_step;     // value k equals v
+        bool nearer_next; // value k + 1 is at least as near to v as value k
+    };
+    template <typename Divider>
+    constexpr grid_position locate(T v, const Divider& div) const {
+        const bool ascending = step > 0;
+        if (0 == _size || (ascending ? v < start : v > start)) {
+            return { true, 0, false, false };
+        }
+        if constexpr (std::is_integral_v<T>) {
+            const distance_type offset = ascending
+                ? static_cast<distance_type>(static_cast<distance_type>(v) - static_cast<distance_type>(start))
+                : static_cast<distance_type>(static_cast<distance_type>(start) - static_cast<distance_type>(v));
+            const distance_type d = divisor();
+            const distance_type q = div.div(offset);
+            const distance_type r = static_cast<distance_type>(offset - q * d);
+            const std::size_t index = q < _size ? static_cast<std::size_t>(q) : _size;
+            return { false, index, index == q && 0 == r, index == q && r >= d - r };
+        } else {
+            const T t = div.div(v - start);
+            if (!(t == t)) {
+                // NaN is after everything and on no step
+                return { false, _size, false, false };
+            }
+            const auto after = [ascending](T a, T b) { return ascending ? a > b : a < b; };
+            std::size_t index = t < static_cast<T>(static_cast<std::int64_t>(_size))
+                ? static_cast<std::size_t>(static_cast<std::int64_t>(constexpr_floor(t))) : _size;
+            // The division may round across a grid value, fix it against the values themselves
+            if (index > 0 && after(value_at(index), v)) {
+                index--;
+            } else if (index < _size && !after(value_at(index + 1), v)) {
+                index++;
+            }
+            const T here = value_at(index);
+            const T next = value_at(index + 1);
+            const bool nearer_next = ascending ? next - v <= v - here : v - next <= here - v;
+            return { false, index, index < _size && here == v, index < _size && nearer_next };
+        }
+    }
+    constexpr value_type make_value([[maybe_unused]] std::size_t k, T v) const {
+        if constexpr (IncludeIndex) {
+            return { k, v };
+        } else {
+            return v;
+        }
+    }
+
     // Start, end, and step size of the range
     T start, _end;
     signed_step_type_t step; 
+    // Trip count
+    std::size_t _size;
+};
+
+/// All pairs (i, j) with i < j < n (strict) or i <= j < n, row by row, behind one linear index:
+/// for(auto [i, j] : triangular_rangex(n)) {
+///   distance[i][j] = ...;
+/// }
+/// =>
+/// for(i = 0; i < n; ++i) for(j = i + 1; j < n; ++j) { ... }
+/// Unlike the nested loop it has size(), O(1) operator[] and subrange(), so it can be cut into
+/// parts with an equal number of pairs, see balanced_part().
+/// Throws std::overflow_error when the pair count does not fit in std::size_t
+/// (n > 6074001000 strict, n > 6074000999 otherwise, with a 64 bit std::size_t).
+template <typename Index = std::size_t>
+class triangular_rangex {
+public:
+    using value_type = std::pair<Index, Index>;
+    struct iterator {
+    public:
+        using value_type = std::pair<Index, Index>;
+        constexpr iterator(value_type pair_, Index n_, bool strict_, std::size_t index_)
+            : i(pair_.first)
+            , j(pair_.second)
+            , n(n_)
+            , strict(strict_)
+            , _index(index_)
+        {
+        }
+        constexpr value_type operator*() const {
+            return { i, j };
+        }
+        // Walk the row, wrap to the diagonal of the next row
+        constexpr iterator& operator++() {
+            if (++j == n) {
+                ++i;
+                j = strict ? i + 1 : i;
+            }
+            _index++;
+            return *this;
+        }
+        constexpr bool operator!=(const iterator& other) const {
+            return _index != other._index;
+        }
+
+    protected:
+        Index i, j;
+        Index n;
+        bool strict;
+        std::size_t _index; // Linear pair index
+    };
+
+    constexpr triangular_rangex(Index n_, bool strict_ = true)
+        : n(n_)
+        , strict(strict_)
+        , _first(0)
+        , _size(0) {
+        const std::uint64_t side = static_cast<std::uint64_t>(n_);
+        std::uint64_t pairs = 0;
+        if (side > 0 && (triangle_overflow(strict_ ? side - 1 : side, pairs) || pairs > SIZE_MAX)) {
+            throw std::overflow_error("triangular_rangex: pair count overflows std::size_t");
+        }
+        _size = static_cast<std::size_t>(pairs);
+    }
+
+    constexpr iterator begin() const {
+        return iterator(pair_at(_first), n, strict, 0);
+    }
+    constexpr iterator end() const {
+        return iterator(value_type{ n, n }, n, strict, _size);
+    }
+
+    constexpr std::size_t size() const {
+        return _size;
+    }
+    constexpr bool empty() const {
+        return 0 == _size;
+    }
+    constexpr value_type operator[](std::size_t k) const {
+        return pair_at(_first + k);
+    }
+    // Pairs [first, first + count) as a triangular_rangex of their own, clamped to size()
+    constexpr triangular_rangex subrange(std::size_t first, std::size_t count) const {
+        triangular_rangex r = *this;
+        first = std::min(first, _size);
+        r._first = _first + first;
+        r._size = std::min(count, _size - first);
+        return r;
+    }
+
+protected:
+    // out = r * (r + 1) / 2, halving the even factor first so the product only overflows
+    // when the result does, returns true then
+    static constexpr bool triangle_overflow(std::uint64_t r, std::uint64_t& out) {
+        return r % 2 ? mul_overflow(r, (r + 1) / 2, out) : mul_overflow(r / 2, r + 1, out);
+    }
+    // r * (r + 1) / 2, the largest uint64_t when that overflows
+    static constexpr std::uint64_t triangle(std::uint64_t r) {
+        std::uint64_t out = 0;
+        return triangle_overflow(r, out) ? UINT64_MAX : out;
+    }
+    // Pair of a linear index over the full triangle. Counted from the last pair, row lengths
+    // are 1, 2, 3, ..., so the row is the largest r with r * (r + 1) / 2 <= k
+    constexpr value_type pair_at(std::size_t linear) const {
+        // i <= j < n is i < j + 1 < n + 1
+        const std::uint64_t side = static_cast<std::uint64_t>(n) + (strict ? 0 : 1);
+        const std::uint64_t total = side ? triangle(side - 1) : 0; // fits, checked by the constructor
+        if (linear >= total) {
+            return { n, n };
+        }
+        const std::uint64_t k = total - 1 - linear;
+        // 2 * isqrt(k / 2) is sqrt(2 * k) within 2 without forming 2 * k, which overflows past 2^63
+        std::uint64_t row = 2 * isqrt(k / 2);
+        while (triangle(row) > k) {
+            row--;
+        }
+        while (triangle(row + 1) <= k) {
+            row++;
+        }
+        const std::uint64_t i = side - 2 - row;
+        const std::uint64_t j = side - 1 - (k - triangle(row)) - (strict ? 0 : 1);
+        return { static_cast<Index>(i), static_cast<Index>(j) };
+    }
+
+    Index n;
+    bool strict;
+    // Window of linear indices covered, the whole triangle unless made by subrange()
+    std::size_t _first, _size;
+};
+
+/// Part k of `parts` consecutive parts with equal size() (the first size() % parts parts get
+/// one value more), for any range with size() and subrange():
+/// auto mine = balanced_part(triangular_rangex(n), workers, worker_id);
+template <typename Range>
+constexpr Range balanced_part(const Range& r, std::size_t parts, std::size_t k) {
+    parts = parts ? parts : 1;
+    const std::size_t base = r.size() / parts;
+    const std::size_t extra = r.size() % parts;
+    const std::size_t first = k * base + std::min(k, extra);
+    return r.subrange(first, base + (k < extra ? 1 : 0));
+}
+
+// Visiting order of the trip indices 0 .. 2^k - 1 of a permuted_rangex
+enum class index_order {
+    bit_reversed, // k-th value is r[reverse of the low bits of k], radix-2 FFT input order
+    gray_code,    // k-th value is r[k ^ (k >> 1)], neighbours differ in one bit
+};
+
+/// Values of a range whose size() is a power of two (or 0, empty), visited in bit-reversed or Gray code order:
+/// for (auto j : bit_reversed(rangex<uint32_t>(0, 1 << 10))) { ... } // 0, 512, 256, 768, ...
+/// for (auto mask : gray_code(rangex<uint32_t>(0, 1 << 10))) { ... } // 0, 1, 3, 2, 6, ...
+/// Iteration updates the permuted index in O(1) amortized (reverse-carry increment for
+/// bit reversal, one bit flip for Gray code), operator[] computes it directly (bswap / rbit).
+/// Has size(), operator[], subrange() and fill() like rangex, so it splits across threads the same way.
+template <typename Range, index_order Order>
+class permuted_rangex {
+public:
+    using value_type = typename Range::value_type;
+
+    // Trip index into the underlying range of position k, for any k < 2^bits
+    static constexpr std::size_t permute(std::size_t k, unsigned bits) {
+        if constexpr (Order == index_order::bit_reversed) {
+            return bits ? static_cast<std::size_t>(reverse_bits(k) >> (64 - bits)) : 0;
+        } else {
+            return k ^ (k >> 1);
+        }
+    }
+
+    class iterator {
+    public:
+        constexpr iterator(const Range& range_, std::size_t index_, unsigned bits_)
+            : range(range_)
+            , _index(index_)
+            , _trip(permute(index_, bits_))
+            , bits(bits_) {
+        }
+        constexpr value_type operator*() const {
+            return range[_trip];
+        }
+        constexpr iterator& operator++() {
+            if constexpr (Order == index_order::bit_reversed) {
+                // Add one at the top bit, carry runs down towards bit 0
+                std::size_t mask = bits ? std::size_t{1} << (bits - 1) : 0;
+                while (_trip & mask) {
+                    _trip ^= mask;
+                    mask >>= 1;
+                }
+                _trip |= mask;
+            }
+            _index++;
+            if constexpr (Order == index_order::gray_code) {
+                // gray(k + 1) is gray(k) with the lowest set bit of k + 1 flipped
+                _trip ^= std::size_t{1} << std::countr_zero(_index);
+            }
+            return *this;
+        }
+        constexpr bool operator!=(const iterator& other) const {
+            return _index != other._index;
+        }
+
+    protected:
+        Range range;
+        std::size_t _index; // Position in visiting order
+        std::size_t _trip;  // Trip index of the underlying range
+        unsigned bits;
+    };
+
+    constexpr explicit permuted_rangex(const Range& range_)
+        : range(range_)
+        , bits(range_.empty() ? 0 : static_cast<unsigned>(std::countr_zero(range_.size())))
+        , _first(0)
+        , _size(range_.size()) {
+        if (!range_.empty() && !std::has_single_bit(range_.size())) {
+            throw std::invalid_argument("permuted_rangex: size() must be 0 or a power of two");
+        }
+    }
+
+    constexpr iterator begin() const {
+        return iterator(range, _first, bits);
+    }
+    constexpr iterator end() const {
+        return iterator(range, _first + _size, bits);
+    }
+
+    constexpr std::size_t size() const {
+        return _size;
+    }
+    constexpr bool empty() const {
+        return 0 == _size;
+    }
+    constexpr value_type operator[](std::size_t k) const {
+        return range[trip_index(k)];
+    }
+    // Trip index into the underlying range of the k-th value
+    constexpr std::size_t trip_index(std::size_t k) const {
+        return permute(_first + k, bits);
+    }
+    // Values [first, first + count) in visiting order, clamped to size()
+    constexpr permuted_rangex subrange(std::size_t first, std::size_t count) const {
+        permuted_rangex r = *this;
+        first = std::min(first, _size);
+        r._first = _first + first;
+        r._size = std::min(count, _size - first);
+        return r;
+    }
+    // Write values [first, first + count) to out, clamped to size(), returns the number written.
+    // Every lane permutes its own index with shifts and masks, no carry chain between lanes,
+    // so the loop vectorizes like rangex::fill()
+    constexpr std::size_t fill(std::size_t first, value_type* out, std::size_t count) const {
+        first = std::min(first, _size);
+        count = std::min(count, _size - first);
+        const std::size_t base = _first + first;
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = range[permute(base + i, bits)];
+        }
+        return count;
+    }
+
+protected:
+    Range range;
+    unsigned bits;
+    // Window of positions covered, all 2^bits unless made by subrange()
+    std::size_t _first, _size;
+};
+
+template <typename Range>
+constexpr permuted_rangex<Range, index_order::bit_reversed> bit_reversed(const Range& r) {
+    return permuted_rangex<Range, index_order::bit_reversed>(r);
+}
+template <typename Range>
+constexpr permuted_rangex<Range, index_order::gray_code> gray_code(const Range& r) {
+    return permuted_rangex<Range, index_order::gray_code>(r);
+}
+
+// Element types an any_rangex can hold
+enum class element_kind : std::uint8_t {
+    u8, i8, u16, i16, u32, i32, u64, i64, f32, f64,
 };
 
+template <typename T> struct element_kind_of;
+template <> struct element_kind_of<std::uint8_t> { static constexpr element_kind value = element_kind::u8; };
+template <> struct element_kind_of<std::int8_t> { static constexpr element_kind value = element_kind::i8; };
+template <> struct element_kind_of<std::uint16_t> { static constexpr element_kind value = element_kind::u16; };
+template <> struct element_kind_of<std::int16_t> { static constexpr element_kind value = element_kind::i16; };
+template <> struct element_kind_of<std::uint32_t> { static constexpr element_kind value = element_kind::u32; };
+template <> struct element_kind_of<std::int32_t> { static constexpr element_kind value = element_kind::i32; };
+template <> struct element_kind_of<std::uint64_t> { static constexpr element_kind value = element_kind::u64; };
+template <> struct element_kind_of<std::int64_t> { static constexpr element_kind value = element_kind::i64; };
+template <> struct element_kind_of<float> { static constexpr element_kind value = element_kind::f32; };
+template <> struct element_kind_of<double> { static constexpr element_kind value = element_kind::f64; };
+
+template <typename T>
+constexpr element_kind element_kind_of_v = element_kind_of<T>::value;
+
+/// rangex with the element type chosen at run time, e.g. from a job config:
+/// any_rangex r = any_rangex::make(element_kind::u16, 0, 1000, false, 3);
+/// alignas(64) std::uint16_t buffer[4096];
+/// r.for_each_batch(std::span(buffer), [](std::span<const std::uint16_t> batch) { ... });
+/// The typed rangex lives in an inline buffer (no allocation), and the one indirect call goes
+/// to rangex<T>::fill() per batch, never per value. The call costs 1-3 ns, batches of a few
+/// thousand values keep it below 1% of a plain range-for (see "any_rangex" in rangex_bench).
+class any_rangex {
+public:
+    template <typename T>
+    any_rangex(const rangex<T>& r)
+        : ops(&ops_for<T>)
+        , _size(r.size()) {
+        static_assert(sizeof(rangex<T>) <= storage_size && alignof(rangex<T>) <= alignof(std::max_align_t));
+        static_assert(std::is_trivially_copyable_v<rangex<T>> && std::is_trivially_destructible_v<rangex<T>>,
+            "storage is copied as bytes and never destroyed");
+        ::new (static_cast<void*>(storage)) rangex<T>(r);
+    }
+
+    // The one switch over element types, for bounds and step read from config as double.
+    // u64 / i64 bounds beyond 2^53 are not exact in double, construct from rangex<T> instead
+    static any_rangex make(element_kind kind, double start_, double end_, bool inclusive = false, double step_ = 1) {
+        switch (kind) {
+        case element_kind::u8: return make_typed<std::uint8_t>(start_, end_, inclusive, step_);
+        case element_kind::i8: return make_typed<std::int8_t>(start_, end_, inclusive, step_);
+        case element_kind::u16: return make_typed<std::uint16_t>(start_, end_, inclusive, step_);
+        case element_kind::i16: return make_typed<std::int16_t>(start_, end_, inclusive, step_);
+        case element_kind::u32: return make_typed<std::uint32_t>(start_, end_, inclusive, step_);
+        case element_kind::i32: return make_typed<std::int32_t>(start_, end_, inclusive, step_);
+        case element_kind::u64: return make_typed<std::uint64_t>(start_, end_, inclusive, step_);
+        case element_kind::i64: return make_typed<std::int64_t>(start_, end_, inclusive, step_);
+        case element_kind::f32: return make_typed<float>(start_, end_, inclusive, step_);
+        case element_kind::f64: return make_typed<double>(start_, end_, inclusive, step_);
+        }
+        throw std::invalid_argument("any_rangex: unknown element_kind");
+    }
+
+    element_kind kind() const {
+        return ops->kind;
+    }
+    std::size_t size() const {
+        return _size;
+    }
+    bool empty() const {
+        return 0 == _size;
+    }
+
+    // Write values [first, first + count) as kind() elements to out, returns the number written
+    std::size_t fill(std::size_t first, void* out, std::size_t count) const {
+        return ops->fill(storage, first, out, count);
+    }
+    // Typed buffer, T must match kind()
+    template <typename T, std::size_t Extent>
+    std::size_t fill(std::size_t first, std::span<T, Extent> out) const {
+        check_kind<T>();
+        return ops->fill(storage, first, out.data(), out.size());
+    }
+    // Whole range through the caller's buffer: fn(std::span<const T>) once per filled batch
+    template <typename T, std::size_t Extent, typename Fn>
+    void for_each_batch(std::span<T, Extent> buffer, Fn&& fn) const {
+        check_kind<T>();
+        if (buffer.empty()) {
+            throw std::invalid_argument("any_rangex: empty batch buffer");
+        }
+        for (std::size_t first = 0; first < _size; ) {
+            std::size_t n = ops->fill(storage, first, buffer.data(), buffer.size());
+            fn(std::span<const T>(buffer.data(), n));
+            first += n;
+        }
+    }
+    // Back to the typed range, T must match kind()
+    template <typename T>
+    rangex<T> get() const {
+        check_kind<T>();
+        return *std::launder(reinterpret_cast<const rangex<T>*>(storage));
+    }
+
+protected:
+    struct ops_t {
+        element_kind kind;
+        std::size_t (*fill)(const void* range, std::size_t first, void* out, std::size_t count);
+    };
+    template <typename T>
+    static std::size_t fill_typed(const void* range, std::size_t first, void* out, std::size_t count) {
+        return std::launder(static_cast<const rangex<T>*>(range))->fill(first, static_cast<T*>(out), count);
+    }
+    template <typename T>
+    static constexpr ops_t ops_for = { element_kind_of_v<T>, &fill_typed<T> };
+
+    template <typename T>
+    static any_rangex make_typed(double start_, double end_, bool inclusive, double step_) {
+        return any_rangex(rangex<T>(config_cast<T>(start_), config_cast<T>(end_), inclusive,
+            config_cast<make_signed_custom_t<T>>(step_)));
+    }
+    // static_cast of a double that does not fit T is undefined, config values are checked first
+    template <typename T>
+    static T config_cast(double v) {
+        if (!std::isfinite(v)) {
+            throw std::invalid_argument("any_rangex: bound or step is not finite");
+        }
+        if constexpr (std::is_integral_v<T>) {
+            // min() is 0 or -2^digits, max() + 1 is 2^digits, both exact in double
+            const double upper = std::ldexp(1.0, std::numeric_limits<T>::digits);
+            if (v < static_cast<double>(std::numeric_limits<T>::min()) || v >= upper || v != std::trunc(v)) {
+                throw std::invalid_argument("any_rangex: bound or step is not a value of the element type");
+            }
+        } else {
+            if (std::fabs(v) > static_cast<double>(std::numeric_limits<T>::max())) {
+                throw std::invalid_argument("any_rangex: bound or step is out of range of the element type");
+            }
+        }
+        return static_cast<T>(v);
+    }
+    template <typename T>
+    void check_kind() const {
+        if (element_kind_of_v<std::remove_const_t<T>> != ops->kind) {
+            throw std::invalid_argument("any_rangex: element type differs from kind()");
+        }
+    }
+
+    static constexpr std::size_t storage_size = std::max({ sizeof(rangex<std::uint64_t>), sizeof(rangex<std::int64_t>), sizeof(rangex<double>) });
+    const ops_t* ops;
+    std::size_t _size;
+    alignas(std::max_align_t) unsigned char storage[storage_size];
+};
+
+/// Inverse queries of one rangex, for hot loops that query the same range many times:
+/// rangex_lookup buckets(rangex<std::uint32_t>(0, 1 << 20, false, 4096));
+/// std::size_t bucket = buckets.lower_bound(key);
+/// The division by the step is replaced by a multiply-shift computed once here
+template <typename T, bool IncludeIndex = false, bool DebugPrint = false, overflow_policy Overflow = overflow_policy::unchecked>
+class rangex_lookup {
+public:
+    using range_type = rangex<T, IncludeIndex, DebugPrint, Overflow>;
+    using distance_type = typename range_type::distance_type;
+
+    constexpr explicit rangex_lookup(const range_type& range_)
+        : range(range_)
+        , div(range_.divisor()) {
+    }
+
+    constexpr bool contains(T v) const {
+        return range.contains(v, div);
+    }
+    constexpr std::optional<std::size_t> index_of(T v) const {
+        return range.index_of(v, div);
+    }
+    constexpr std::size_t lower_bound(T v) const {
+        return range.lower_bound(v, div);
+    }
+    constexpr std::size_t upper_bound(T v) const {
+        return range.upper_bound(v, div);
+    }
+    constexpr T clamp_to_grid(T v) const {
+        return range.clamp_to_grid(v, div);
+    }
+    constexpr const range_type& get() const {
+        return range;
+    }
+
+protected:
+    range_type range;
+    fast_divider<distance_type> div;
+};
+
+/// Lookup table generated at compile time, table[k] = fn(r[k]):
+/// constexpr auto squares = make_table<16>(rangex<int>(0, 16), [](int v) { return v * v; });
+/// N must equal r.size(), a mismatch fails the constant evaluation (throws at run time)
+template <std::size_t N, typename T, bool IncludeIndex, bool DebugPrint, overflow_policy Overflow, typename Fn>
+constexpr auto make_table(const rangex<T, IncludeIndex, DebugPrint, Overflow>& r, Fn fn) {
+    using value_type = typename rangex<T, IncludeIndex, DebugPrint, Overflow>::value_type;
+    std::array<std::invoke_result_t<Fn&, value_type>, N> table{};
+    if (r.size() != N) {
+        throw std::length_error("make_table: N differs from rangex size()");
+    }
+    std::size_t k = 0;
+    r.for_each([&table, &fn, &k](value_type v) { table[k++] = fn(v); });
+    return table;
+}
+
+/// Same, with the table size taken from the range itself:
+/// constexpr auto crc_table = make_table<[] { return rangex<uint32_t>(0, 256); }>(crc_of_byte);
+template <auto MakeRange, typename Fn>
+consteval auto make_table(Fn fn) {
+    constexpr auto r = MakeRange();
+    return make_table<r.size()>(r, fn);
+}
+
 } // namespace ns_rangex
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "rangex_lib.h"
+
+#include <atomic>
+#include <optional>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ns_rangex {
+
+// Fixed instead of std::hardware_destructive_interference_size, which is not ABI stable
+// (GCC warns on use in headers) and not provided by every standard library
+constexpr std::size_t cache_line_size = 64;
+
+enum class schedule_kind {
+    dynamic_chunk, // every claim is `chunk` values, like OpenMP schedule(dynamic, chunk)
+    guided,        // remaining / (2 * workers), never below `chunk`, like schedule(guided, chunk)
+};
+
+/// Hands out consecutive subranges of one rangex to any number of threads:
+/// concurrent_cursor<rangex<int>> cursor(rangex<int>(0, 1000000), 256);
+/// // on each worker thread
+/// while (auto part = cursor.try_next()) {
+///     for (auto v : *part) { ... }
+/// }
+/// A claim is one atomic fetch_add on the shared trip index, no locks and no CAS retry.
+template <typename Range>
+class concurrent_cursor {
+public:
+    concurrent_cursor(const Range& range_, std::size_t chunk_ = 1,
+        schedule_kind kind_ = schedule_kind::dynamic_chunk, std::size_t workers_ = 1)
+        : range(range_)
+        , chunk(chunk_ ? chunk_ : 1)
+        , kind(kind_)
+        , _next(0)
+        , _workers(workers_ ? workers_ : 1) {
+    }
+
+    concurrent_cursor(const concurrent_cursor&) = delete;
+    concurrent_cursor& operator=(const concurrent_cursor&) = delete;
+
+    // Next subrange to process, std::nullopt once every value is handed out
+    std::optional<Range> try_next() {
+        const std::size_t total = range.size();
+        // Plain load first, so threads polling an exhausted cursor do not keep bumping _next
+        std::size_t seen = _next.load(std::memory_order_relaxed);
+        if (seen >= total) {
+            return std::nullopt;
+        }
+        std::size_t count = chunk;
+        if (kind == schedule_kind::guided) {
+            // Sized from a possibly stale position, that only makes the claim a bit larger
+            std::size_t guided = (total - seen) / (2 * _workers.load(std::memory_order_relaxed));
+            count = std::max(count, guided);
+        }
+        std::size_t first = _next.fetch_add(count, std::memory_order_relaxed);
+        if (first >= total) {
+            return std::nullopt;
+        }
+        return range.subrange(first, count);
+    }
+
+    // Worker count may change while running, only the guided chunk size depends on it
+    void set_workers(std::size_t workers_) {
+        _workers.store(workers_ ? workers_ : 1, std::memory_order_relaxed);
+    }
+    // Values not handed out yet
+    std::size_t remaining() const {
+        std::size_t seen = _next.load(std::memory_order_relaxed);
+        return seen < range.size() ? range.size() - seen : 0;
+    }
+    // Start handing out from the beginning again, not thread safe with try_next()
+    void reset() {
+        _next.store(0, std::memory_order_relaxed);
+    }
+
+protected:
+    const Range range;
+    const std::size_t chunk;
+    const schedule_kind kind;
+    // Written by every claim, keep it away from the read-only members above and below
+    alignas(cache_line_size) std::atomic<std::size_t> _next;
+    alignas(cache_line_size) std::atomic<std::size_t> _workers;
+};
+
+enum class reduce_compensation {
+    none,     // leaf block summed left to right with combine
+    kahan,    // leaf block summed with Kahan compensation, combine must be std::plus
+    pairwise, // leaf block halved recursively, combine applied on the halves
+};
+
+// Leaf block size of parallel_reduce(), part of the reduction tree shape and so of the result
+constexpr std::size_t reduce_leaf_size = 4096;
+
+namespace reduce_detail {
+
+// The Kahan leaf adds with + whatever combine is, so it is only allowed when combine is addition
+template <typename Combine, typename Acc>
+constexpr bool is_addition_v = std::is_same_v<Combine, std::plus<>> || std::is_same_v<Combine, std::plus<Acc>>;
+
+// Sequential part of a leaf, the first value seeds the accumulator, so no identity is needed
+template <typename Range, typename Map, typename Combine>
+auto reduce_leaf(const Range& leaf, Map& map, Combine& combine, reduce_compensation compensation)
+    -> decltype(map(*leaf.begin())) {
+    using acc_type = decltype(map(*leaf.begin()));
+    if (compensation == reduce_compensation::pairwise && leaf.size() > 8) {
+        const std::size_t half = leaf.size() / 2;
+        acc_type lo = reduce_leaf(leaf.subrange(0, half), map, combine, compensation);
+        acc_type hi = reduce_leaf(leaf.subrange(half, leaf.size() - half), map, combine, compensation);
+        return combine(lo, hi);
+    }
+    auto it = leaf.begin();
+    acc_type acc = map(*it);
+    ++it;
+    if constexpr (std::is_floating_point_v<acc_type>) {
+        if (compensation == reduce_compensation::kahan) {
+            acc_type c{};
+            for (; it != leaf.end(); ++it) {
+                acc_type y = map(*it) - c;
+                acc_type t = acc + y;
+                c = (t - acc) - y;
+                acc = t;
+            }
+            return acc;
+        }
+    }
+    for (; it != leaf.end(); ++it) {
+        acc = combine(acc, map(*it));
+    }
+    return acc;
+}
+
+// Fixed binary tree over the leaf results, its shape depends only on their count
+template <typename Acc, typename Combine>
+Acc reduce_tree(const Acc* leaves, std::size_t count, Combine& combine) {
+    if (count == 1) {
+        return leaves[0];
+    }
+    const std::size_t half = count / 2;
+    Acc lo = reduce_tree(leaves, half, combine);
+    Acc hi = reduce_tree(leaves + half, count - half, combine);
+    return combine(lo, hi);
+}
+
+} // namespace reduce_detail
+
+/// combine(init, reduction of map(v) over every value v of the range), bit-identical for any thread count:
+/// double s = parallel_reduce(rangex<double>(0.0, 1.0, false, 1e-7), 0.0,
+///     [](double x) { return std::sin(x); }, std::plus<>(), threads, reduce_compensation::kahan);
+/// The range is cut into leaf blocks of leaf_size trip indices, each reduced left to right
+/// (or with Kahan / pairwise compensation), then the leaf results meet in a binary tree built
+/// over leaf indices. Threads only decide who computes which leaf (claimed through a
+/// concurrent_cursor), never the order of the operations, so floating point sums round the
+/// same on 1 or 64 threads. The result does change with leaf_size.
+/// Kahan compensation throws std::invalid_argument unless combine is std::plus.
+template <typename Range, typename T, typename Map, typename Combine>
+T parallel_reduce(const Range& range, T init, Map map, Combine combine, std::size_t threads = 1,
+    reduce_compensation compensation = reduce_compensation::none, std::size_t leaf_size = reduce_leaf_size) {
+    using acc_type = decltype(map(*range.begin()));
+    if (compensation == reduce_compensation::kahan && !reduce_detail::is_addition_v<Combine, acc_type>) {
+        throw std::invalid_argument("parallel_reduce: Kahan compensation needs std::plus as combine");
+    }
+    if (range.empty()) {
+        return init;
+    }
+    leaf_size = leaf_size ? leaf_size : 1;
+    const std::size_t leaves = (range.size() - 1) / leaf_size + 1;
+    std::vector<acc_type> partial(leaves);
+    const auto reduce_leaves = [&](const rangex<std::size_t>& part) {
+        for (std::size_t leaf : part) {
+            partial[leaf] = reduce_detail::reduce_leaf(range.subrange(leaf * leaf_size, leaf_size), map, combine, compensation);
+        }
+    };
+    threads = std::min(threads, leaves);
+    if (threads <= 1) {
+        reduce_leaves(rangex<std::size_t>(0, leaves));
+    } else {
+        concurrent_cursor<rangex<std::size_t>> cursor(rangex<std::size_t>(0, leaves), 1, schedule_kind::guided, threads);
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&cursor, &reduce_leaves] {
+                while (auto part = cursor.try_next()) {
+                    reduce_leaves(*part);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    return static_cast<T>(combine(init, reduce_detail::reduce_tree(partial.data(), leaves, combine)));
+}
+
+} // namespace ns_rangex
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "rangex_lib.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace ns_rangex {
+
+/// Walks a range a slice at a time, keeping only the trip position between slices:
+/// resumable_cursor cursor(rangex<int>(0, 100000000));
+/// while (!cursor.done()) {
+///     cursor.run_for(std::chrono::microseconds(20), [](int v) { ... });
+///     // yield to the event loop
+/// }
+/// fn gets range[k] for trip index k, computed from k alone (no value carried across values or
+/// slices), so a float range gives the same values however it is sliced, saved and restored.
+/// The position saves to at most max_state_size bytes and restores in O(1),
+/// so a batch job can checkpoint and continue after a restart instead of starting from zero.
+/// CheckEvery is how many values run between two reads of the clock.
+template <typename Range, std::size_t CheckEvery = 256>
+class resumable_cursor {
+    static_assert(CheckEvery > 0, "resumable_cursor: CheckEvery must be at least 1");
+public:
+    using clock = std::chrono::steady_clock;
+    // Position as LEB128: 7 bits per byte, 10 bytes for any 64 bit position, 1 byte below 128
+    static constexpr std::size_t max_state_size = (sizeof(std::size_t) * 8 + 6) / 7;
+
+    explicit resumable_cursor(const Range& range_, std::size_t position_ = 0)
+        : range(range_)
+        , _position(std::min(position_, range_.size())) {
+    }
+
+    // Trip index of the next value to process
+    std::size_t position() const {
+        return _position;
+    }
+    std::size_t size() const {
+        return range.size();
+    }
+    std::size_t remaining() const {
+        return range.size() - _position;
+    }
+    bool done() const {
+        return _position == range.size();
+    }
+    // Jump to any trip index, clamped to size()
+    void seek(std::size_t position_) {
+        _position = std::min(position_, range.size());
+    }
+
+    // Writes the position to out, returns the number of bytes used
+    std::size_t save(std::span<std::uint8_t, max_state_size> out) const {
+        std::size_t value = _position;
+        std::size_t n = 0;
+        do {
+            std::uint8_t byte = static_cast<std::uint8_t>(value & 0x7F);
+            value >>= 7;
+            out[n++] = static_cast<std::uint8_t>(byte | (value ? 0x80 : 0));
+        } while (value);
+        return n;
+    }
+    // Position from save(), false (cursor unchanged) for a truncated or overlong state
+    // or a position past the end of the range
+    bool restore(std::span<const std::uint8_t> state) {
+        std::size_t value = 0;
+        for (std::size_t n = 0; n < state.size() && n < max_state_size; ++n) {
+            const std::size_t bits = static_cast<std::size_t>(state[n] & 0x7F);
+            const unsigned shift = static_cast<unsigned>(7 * n);
+            if (shift + 7 > sizeof(std::size_t) * 8 && (bits >> (sizeof(std::size_t) * 8 - shift))) {
+                return false;
+            }
+            value |= bits << shift;
+            if (!(state[n] & 0x80)) {
+                if (n + 1 != state.size() || value > range.size()) {
+                    return false;
+                }
+                _position = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Calls fn on at most `elements` next values, returns how many ran
+    template <typename Fn>
+    std::size_t run_for(std::size_t elements, Fn&& fn) {
+        return run(elements, nullptr, fn);
+    }
+    // Calls fn on next values until the deadline passes, the clock is read once every CheckEvery
+    // values, so a slice overshoots the deadline by at most CheckEvery - 1 calls of fn
+    // and always makes progress, even with a deadline already in the past
+    template <typename Fn>
+    std::size_t run_for(clock::time_point deadline, Fn&& fn, std::size_t elements = static_cast<std::size_t>(-1)) {
+        return run(elements, &deadline, fn);
+    }
+    template <typename Rep, typename Period, typename Fn>
+    std::size_t run_for(std::chrono::duration<Rep, Period> budget, Fn&& fn, std::size_t elements = static_cast<std::size_t>(-1)) {
+        const clock::time_point deadline = clock::now() + std::chrono::duration_cast<clock::duration>(budget);
+        return run(elements, &deadline, fn);
+    }
+
+protected:
+    template <typename Fn>
+    std::size_t run(std::size_t elements, const clock::time_point* deadline, Fn& fn) {
+        const std::size_t start = _position;
+        const std::size_t last = _position + std::min(elements, remaining());
+        while (_position < last) {
+            // No clock, no budget check inside a slice: a plain indexed loop. range[k] rather than
+            // a range-for over subrange(), whose float iterator adds step to a value that restarts
+            // at every slice boundary and whose index restarts at 0
+            const std::size_t count = deadline ? std::min(CheckEvery, last - _position) : last - _position;
+            for (std::size_t k = _position; k < _position + count; ++k) {
+                fn(range[k]);
+            }
+            _position += count;
+            if (deadline && clock::now() >= *deadline) {
+                break;
+            }
+        }
+        return _position - start;
+    }
+
+    const Range range;
+    std::size_t _position;
+};
+
+} // namespace ns_rangex
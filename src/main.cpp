@@ -5,12 +5,24 @@
 #include <cstdint>
 #include <type_traits>
 #include <cassert>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <bit>
 
 #ifdef _MSC_VER
 #define COMPILER_HAS_NO_STD_FLOAT
 #endif
 
 #include "rangex_lib.h"
+#include "rangex_parallel.h"
+#include "rangex_histogram.h"
+#include "rangex_resumable.h"
 using namespace ns_rangex;
 
 // test_framework provides main()
@@ -388,3 +400,1065 @@ TEST_CASE_EX(SkipTest, float128_cause_trouble) {
     constexpr int float_bits = 64; //128
     verify_for_loop_range<element_type_t>(expect, sizeof(expect)/sizeof(expect[0]) - 1, rangex<element_type_t, false>(scf<float_bits>(1.0f), scf<float_bits>(2.0f), true, scf<float_bits>(0.5f)));
 }
+
+TEST_CASE_EX(rangex_test, size_and_random_access) {
+    CHECK_EQ(rangex(1, 6).size(), 5u);
+    CHECK_EQ(rangex(1, 9, true, 3).size(), 3u);
+    CHECK_EQ(rangex(5, 1, true, -1).size(), 5u);
+    CHECK(rangex(2, 1).empty());
+    CHECK(rangex(1, 2, false, 0).empty());
+
+    auto r = rangex<uint8_t>(5, 0, true, -1);
+    CHECK_EQ(r.size(), 6u);
+    CHECK_EQ(r[0], 5);
+    CHECK_EQ(r[5], 0);
+
+    auto ri = rangex<int, true>(10, 0, false, -3);
+    CHECK_EQ(ri.size(), 4u);
+    CHECK_EQ(ri[3].first, 3u);
+    CHECK_EQ(ri[3].second, 1);
+
+    auto rf = rangex<std::float64_t>(scf<64>(1.0), scf<64>(2.0), true, scf<64>(0.25));
+    CHECK_EQ(rf.size(), 5u);
+    CHECK_EQ(rf[4], scf<64>(2.0));
+}
+
+template <std::size_t Unroll, typename T>
+void verify_unrolled_for_each(rangex<T, false> r) {
+    std::vector<T> expect;
+    for (auto v : r) {
+        expect.push_back(v);
+    }
+    std::vector<T> got;
+    r.template for_each<Unroll>([&got](T v) { got.push_back(v); });
+    CHECK(got == expect);
+
+    got.clear();
+    r.template for_each_n<Unroll>(expect.size() / 2 + 1, [&got](T v) { got.push_back(v); });
+    CHECK_EQ(got.size(), std::min(expect.size(), expect.size() / 2 + 1));
+    CHECK(std::equal(got.begin(), got.end(), expect.begin()));
+}
+
+TEST_CASE_EX(rangex_test, unrolled_for_each_with_remainder) {
+    // 1..100 gives a remainder for every unroll factor except 1, 2 and 4
+    verify_unrolled_for_each<1, int>(rangex<int>(1, 100, true));
+    verify_unrolled_for_each<3, int>(rangex<int>(1, 100, true));
+    verify_unrolled_for_each<8, int>(rangex<int>(1, 100, true));
+    verify_unrolled_for_each<16, int>(rangex<int>(1, 100, true));
+    // 200, 193, ..., 4: the span of a descending unsigned range must not wrap in T
+    CHECK_EQ(rangex<uint8_t>(200, 0, true, -7).size(), 29u);
+    verify_unrolled_for_each<4, uint8_t>(rangex<uint8_t>(200, 0, true, -7));
+    verify_unrolled_for_each<8, std::float32_t>(rangex<std::float32_t>(scf<32>(1.0f), scf<32>(9.0f), false, scf<32>(3.0f)));
+    // Non-dyadic float step: every unroll factor passes exactly r[k]
+    const auto tenths = rangex<std::float32_t>(scf<32>(0.0f), scf<32>(100.0f), false, scf<32>(0.1f));
+    auto verify_closed_form = [&tenths](auto unroll) {
+        std::size_t k = 0;
+        tenths.for_each<decltype(unroll)::value>([&tenths, &k](std::float32_t v) {
+            CHECK_EQ(v, tenths[k]);
+            ++k;
+        });
+        CHECK_EQ(k, tenths.size());
+    };
+    verify_closed_form(std::integral_constant<std::size_t, 1>{});
+    verify_closed_form(std::integral_constant<std::size_t, 4>{});
+    verify_closed_form(std::integral_constant<std::size_t, 7>{});
+    verify_closed_form(std::integral_constant<std::size_t, 16>{});
+    // Shorter than one unrolled body
+    verify_unrolled_for_each<16, int>(rangex<int>(1, 4));
+    verify_unrolled_for_each<16, int>(rangex<int>(1, 1));
+
+    std::size_t count = 0;
+    rangex<int, true>(0, 10).for_each<4>([&count](auto iv) {
+        CHECK_EQ(iv.first, count++);
+        CHECK_EQ(static_cast<std::size_t>(iv.second), iv.first);
+    });
+    CHECK_EQ(count, 10u);
+}
+
+TEST_CASE_EX(rangex_test, for_each_and_reduce_yield_operator_index_values) {
+    // Floats: for_each(), for_each_n() and reduce() see r[k] = start + k * step bit for bit,
+    // a range-for accumulates `value += step` and only stays close to it
+    const auto r = rangex<float>(0.0f, 100.0f, false, 0.1f);
+    std::size_t k = 0;
+    r.for_each<4>([&](float v) {
+        CHECK_EQ(std::bit_cast<std::uint32_t>(v), std::bit_cast<std::uint32_t>(r[k]));
+        ++k;
+    });
+    CHECK_EQ(k, r.size());
+    k = 0;
+    r.for_each_n<8>(37, [&](float v) { CHECK_EQ(std::bit_cast<std::uint32_t>(v), std::bit_cast<std::uint32_t>(r[k++])); });
+    CHECK_EQ(k, 37u);
+    double sum = 0;
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        sum += r[i];
+    }
+    CHECK_EQ(r.reduce<1>(0.0, [](double a, float v) { return a + v; }), sum);
+    k = 0;
+    for (float v : r) {
+        CHECK(std::fabs(v - r[k]) < 1e-3f);
+        ++k;
+    }
+    CHECK_EQ(k, r.size());
+}
+
+TEST_CASE_EX(rangex_test, reduce_with_partial_accumulators) {
+    CHECK_EQ(rangex<int>(1, 100, true).reduce<1>(0), 5050);
+    CHECK_EQ(rangex<int>(1, 100, true).reduce<8>(0), 5050);
+    CHECK_EQ(rangex<int>(1, 100, true).reduce<16>(10), 5060);
+    CHECK_EQ(rangex<int>(1, 4).reduce<16>(0), 6);
+    CHECK_EQ(rangex<int>(1, 1).reduce<16>(7), 7);
+    CHECK_EQ(rangex<uint8_t>(1, 100, true).reduce<4>(std::uint32_t{0}), 5050u);
+    CHECK_EQ(rangex<int>(1, 10, true).reduce<4>(1, std::multiplies<>{}, std::multiplies<>{}, 1), 3628800);
+    CHECK_EQ(rangex<int>(1, 10, true).reduce<1>(1, std::multiplies<>{}), 3628800);
+    // op that is not a monoid on T: lanes fold with op, lanes are added up with combine
+    const auto add_square = [](int a, int v) { return a + v * v; };
+    CHECK_EQ(rangex<int>(1, 8, true).reduce<1>(0, add_square), 204);
+    CHECK_EQ(rangex<int>(1, 8, true).reduce<4>(0, add_square), 204);
+    CHECK_EQ(rangex<int>(1, 9, true).reduce<4>(0, add_square), 285);
+    CHECK_EQ(rangex<int>(1, 9, true).reduce<8>(5, add_square), 290);
+    CHECK_EQ(rangex<int>(-50, 50).reduce<4>(INT_MIN, [](int a, int v) { return std::max(a, v % 7); },
+        [](int a, int b) { return std::max(a, b); }, INT_MIN), 6);
+    // Small integers are exact in float, so any association order gives the same sum
+    CHECK_EQ(rangex<std::float32_t>(scf<32>(1.0f), scf<32>(100.0f), true).reduce<8>(scf<32>(0.0f)), scf<32>(5050.0f));
+}
+
+TEST_CASE_EX(rangex_test, constexpr_construct_iterate_and_index) {
+    constexpr auto r = rangex<int>(5, 1, true, -1);
+    static_assert(r.size() == 5);
+    static_assert(r[0] == 5 && r[4] == 1);
+    static_assert([] {
+        int sum = 0;
+        for (auto v : rangex<uint8_t>(1, 100, true)) {
+            sum += v;
+        }
+        return sum;
+    }() == 5050);
+    static_assert(rangex<int>(1, 100, true).reduce<8>(0) == 5050);
+    static_assert(rangex<int, true>(10, 0, false, -3)[3].second == 1);
+
+    // Float closed-form helpers replaced by constexpr_floor / constexpr_fmod at compile time
+    constexpr auto rf = rangex<std::float64_t>(scf<64>(1.0), scf<64>(9.0), true, scf<64>(3.0));
+    static_assert(rf.size() == 3);
+    static_assert(rangex<std::float32_t>(scf<32>(5.0f), scf<32>(1.0f), true, scf<32>(-1.0f)).size() == 5);
+    static_assert(rangex<std::float64_t>(scf<64>(0.0), scf<64>(1.0), true, scf<64>(0.125)).size() == 9);
+    static_assert(constexpr_floor(-1.5) == -2.0 && constexpr_floor(1.5) == 1.0 && constexpr_floor(-2.0) == -2.0);
+    static_assert(constexpr_fmod(7.0, 3.0) == 1.0 && constexpr_fmod(-7.0, 3.0) == -1.0);
+    CHECK_EQ(constexpr_floor(-1.5), std::floor(-1.5));
+    CHECK_EQ(constexpr_fmod(7.5, 2.0), std::fmod(7.5, 2.0));
+}
+
+// size() of a range built while constant evaluating, and of the same range built at run time
+template <typename T, T Start, T End, bool Inclusive, T Step>
+void verify_constexpr_size_matches_runtime() {
+    constexpr std::size_t at_compile_time = rangex<T>(Start, End, Inclusive, Step).size();
+    volatile T start = Start, end = End, step = Step;
+    CHECK_EQ(at_compile_time, rangex<T>(start, end, Inclusive, step).size());
+}
+
+TEST_CASE_EX(rangex_test, constexpr_size_matches_runtime_for_non_dyadic_steps) {
+    verify_constexpr_size_matches_runtime<double, 0.0, 1.0, false, 0.1>();
+    verify_constexpr_size_matches_runtime<double, 0.0, 1.0, true, 0.1>();
+    verify_constexpr_size_matches_runtime<double, 0.0, 3.0, false, 0.3>();
+    verify_constexpr_size_matches_runtime<double, 1.0, 8.0, false, 0.7>();
+    verify_constexpr_size_matches_runtime<double, 0.0, 1.0, false, 1.0 / 3.0>();
+    verify_constexpr_size_matches_runtime<double, -2.5, 7.3, true, 0.01>();
+    verify_constexpr_size_matches_runtime<double, 1.0, 0.0, false, -0.1>();
+    verify_constexpr_size_matches_runtime<float, 0.0f, 1.0f, false, 0.1f>();
+    verify_constexpr_size_matches_runtime<float, 0.0f, 100.0f, false, 0.1f>();
+    verify_constexpr_size_matches_runtime<float, 5.0f, -5.0f, true, -0.3f>();
+
+    // Exact remainder, bit for bit the same as std::fmod
+    constexpr double xs[] = { 1.0, 0.7, -3.3, 1e300, 123456.789, 5e-324, -0.0 };
+    constexpr double ys[] = { 0.1, 0.3, -0.7, 1e-300, 3.0, 1.0 / 3.0 };
+    constexpr auto table = [&] {
+        std::array<double, std::size(xs) * std::size(ys)> out{};
+        for (std::size_t i = 0; i < std::size(xs); ++i) {
+            for (std::size_t j = 0; j < std::size(ys); ++j) {
+                out[i * std::size(ys) + j] = constexpr_fmod(xs[i], ys[j]);
+            }
+        }
+        return out;
+    }();
+    for (std::size_t i = 0; i < std::size(xs); ++i) {
+        for (std::size_t j = 0; j < std::size(ys); ++j) {
+            const double expect = std::fmod(xs[i], ys[j]);
+            CHECK_EQ(std::memcmp(&table[i * std::size(ys) + j], &expect, sizeof(double)), 0);
+        }
+    }
+}
+
+constexpr std::uint32_t crc32_of_byte(std::uint32_t c) {
+    for (int bit = 0; bit < 8; ++bit) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    return c;
+}
+
+TEST_CASE_EX(rangex_test, make_table_at_compile_time) {
+    constexpr auto crc_table = make_table<[] { return rangex<std::uint32_t>(0, 256); }>(crc32_of_byte);
+    static_assert(crc_table.size() == 256);
+    static_assert(crc_table[0] == 0 && crc_table[1] == 0x77073096u && crc_table[255] == 0x2D02EF8Du);
+
+    constexpr auto squares = make_table<5>(rangex<int>(5, 1, true, -1), [](int v) { return v * v; });
+    static_assert(squares[0] == 25 && squares[4] == 1);
+
+    constexpr auto halves = make_table<4>(rangex<std::float64_t>(scf<64>(0.0), scf<64>(2.0), false, scf<64>(0.5)),
+        [](std::float64_t v) { return v * 2; });
+    static_assert(halves[3] == scf<64>(3.0));
+
+    auto wrong_size = [] { return make_table<3>(rangex<int>(0, 4), [](int v) { return v; }); };
+    EXPECT_THROW(wrong_size(), std::length_error);
+}
+
+TEST_CASE_EX(rangex_test, subrange_of_float_range_ends_on_trip_count) {
+    // 0.1f does not add up exactly, the loop must still stop after 10 values
+    auto r = rangex<std::float32_t>(scf<32>(0.0f), scf<32>(0.95f), false, scf<32>(0.1f));
+    CHECK_EQ(r.size(), 10u);
+    std::size_t count = 0;
+    for (auto v : r.subrange(3, 100)) {
+        CHECK(v > scf<32>(0.25f));
+        count++;
+    }
+    CHECK_EQ(count, 7u);
+    CHECK(r.subrange(10, 1).empty());
+    CHECK(r.subrange(20, 1).empty());
+
+    auto sub = rangex<int, true>(10, 0, false, -1).subrange(2, 3);
+    std::size_t index = 0;
+    for (auto [i, v] : sub) {
+        CHECK_EQ(i, index++);
+        CHECK_EQ(v, static_cast<int>(8 - i));
+    }
+    CHECK_EQ(index, 3u);
+}
+
+template <schedule_kind Kind>
+void verify_concurrent_cursor_hands_out_each_value_once(std::size_t threads) {
+    constexpr int n = 100003;
+    std::vector<std::atomic<int>> seen(n);
+    concurrent_cursor<rangex<int>> cursor(rangex<int>(0, n), 64, Kind, threads);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&cursor, &seen] {
+            while (auto part = cursor.try_next()) {
+                for (auto v : *part) {
+                    seen[v].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    CHECK_EQ(cursor.remaining(), 0u);
+    CHECK(std::all_of(seen.begin(), seen.end(), [](const std::atomic<int>& c) { return c.load() == 1; }));
+}
+
+TEST_CASE_EX(rangex_test, concurrent_cursor_dynamic_and_guided) {
+    verify_concurrent_cursor_hands_out_each_value_once<schedule_kind::dynamic_chunk>(1);
+    verify_concurrent_cursor_hands_out_each_value_once<schedule_kind::dynamic_chunk>(8);
+    verify_concurrent_cursor_hands_out_each_value_once<schedule_kind::guided>(1);
+    verify_concurrent_cursor_hands_out_each_value_once<schedule_kind::guided>(8);
+
+    // Guided chunks shrink with the remaining work, but not below the minimum chunk
+    concurrent_cursor<rangex<int>> cursor(rangex<int>(0, 1000), 10, schedule_kind::guided, 2);
+    std::size_t last = 1000;
+    std::size_t total = 0;
+    while (auto part = cursor.try_next()) {
+        CHECK(part->size() <= last);
+        CHECK(part->size() >= 10u || cursor.remaining() == 0);
+        last = part->size();
+        total += part->size();
+    }
+    CHECK_EQ(total, 1000u);
+    CHECK(!cursor.try_next().has_value());
+}
+
+TEST_CASE_EX(rangex_test, isqrt_exact_for_all_magnitudes) {
+    static_assert(isqrt(0) == 0 && isqrt(1) == 1 && isqrt(2) == 1 && isqrt(15) == 3 && isqrt(16) == 4);
+    static_assert(isqrt(0xFFFFFFFFFFFFFFFFull) == 0xFFFFFFFFull);
+    CHECK_EQ(isqrt(0xFFFFFFFFFFFFFFFFull), 0xFFFFFFFFull);
+    CHECK_EQ(isqrt(0xFFFFFFFE00000001ull), 0xFFFFFFFFull);
+    CHECK_EQ(isqrt(0xFFFFFFFE00000000ull), 0xFFFFFFFEull);
+    for (std::uint64_t r = 1; r < 3000000000ull; r = r * 3 + 1) {
+        CHECK_EQ(isqrt(r * r), r);
+        CHECK_EQ(isqrt(r * r - 1), r - 1);
+    }
+}
+
+void verify_triangular_rangex(std::size_t n, bool strict) {
+    std::vector<std::pair<std::size_t, std::size_t>> expect;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = strict ? i + 1 : i; j < n; ++j) {
+            expect.emplace_back(i, j);
+        }
+    }
+    auto tri = triangular_rangex(n, strict);
+    CHECK_EQ(tri.size(), expect.size());
+    std::size_t index = 0;
+    for (auto [i, j] : tri) {
+        CHECK(index < expect.size());
+        CHECK(std::make_pair(i, j) == expect[index]);
+        CHECK(tri[index] == expect[index]);
+        index++;
+    }
+    CHECK_EQ(index, expect.size());
+
+    // Parts are consecutive, cover every pair once, and differ in size by at most 1
+    for (std::size_t parts : {1, 3, 7}) {
+        std::size_t next = 0;
+        for (std::size_t k = 0; k < parts; ++k) {
+            auto part = balanced_part(tri, parts, k);
+            CHECK(part.size() == tri.size() / parts || part.size() == tri.size() / parts + 1);
+            for (auto pair : part) {
+                CHECK(pair == expect[next++]);
+            }
+        }
+        CHECK_EQ(next, expect.size());
+    }
+}
+
+TEST_CASE_EX(rangex_test, triangular_rangex_pairs_and_balanced_parts) {
+    for (std::size_t n : {0, 1, 2, 3, 7, 64}) {
+        verify_triangular_rangex(n, true);
+        verify_triangular_rangex(n, false);
+    }
+    static_assert(triangular_rangex<int>(5).size() == 10);
+    static_assert(triangular_rangex<int>(5)[9] == std::pair<int, int>{3, 4});
+
+    // Random access far into a large triangle, no iteration needed
+    const std::size_t n = 3000000000ull;
+    auto big = triangular_rangex(n);
+    CHECK(big[0] == std::make_pair(std::size_t{0}, std::size_t{1}));
+    CHECK(big[n - 1] == std::make_pair(std::size_t{1}, std::size_t{2}));
+    CHECK(big[big.size() - 1] == std::make_pair(n - 2, n - 1));
+
+    // Pair counts past 2^63 up to the last n whose count fits in size_t, then overflow_error
+    const std::size_t largest = 6074001000ull;
+    auto huge = triangular_rangex(largest);
+    CHECK_EQ(huge.size(), 18446744070963499500ull);
+    CHECK(huge[0] == std::make_pair(std::size_t{0}, std::size_t{1}));
+    CHECK(huge[largest - 2] == std::make_pair(std::size_t{0}, largest - 1));
+    CHECK(huge[largest - 1] == std::make_pair(std::size_t{1}, std::size_t{2}));
+    CHECK(huge[huge.size() - 3] == std::make_pair(largest - 3, largest - 2));
+    CHECK(huge[huge.size() - 2] == std::make_pair(largest - 3, largest - 1));
+    CHECK(huge[huge.size() - 1] == std::make_pair(largest - 2, largest - 1));
+    const std::size_t row = 1000000000;
+    const std::size_t row_start = row * (largest - 1) - row * (row - 1) / 2;
+    CHECK(huge[row_start - 1] == std::make_pair(row - 1, largest - 1));
+    CHECK(huge[row_start] == std::make_pair(row, row + 1));
+    CHECK(huge.subrange(row_start, 10)[0] == std::make_pair(row, row + 1));
+    auto huge_diagonal = triangular_rangex(largest - 1, false);
+    CHECK_EQ(huge_diagonal.size(), huge.size());
+    CHECK(huge_diagonal[0] == std::make_pair(std::size_t{0}, std::size_t{0}));
+    CHECK(huge_diagonal[huge_diagonal.size() - 1] == std::make_pair(largest - 2, largest - 2));
+    EXPECT_THROW(triangular_rangex(largest + 1), std::overflow_error);
+    EXPECT_THROW(triangular_rangex(largest, false), std::overflow_error);
+    EXPECT_THROW(triangular_rangex(std::size_t{1} << 33), std::overflow_error);
+    // Past 2^32 the product n * (n - 1) overflows before the halving, the count does not
+    CHECK_EQ(triangular_rangex((std::size_t{1} << 32) + 1).size(), 9223372039002259456ull);
+
+    // balanced_part() works on plain rangex too
+    auto r = rangex<int>(0, 10);
+    CHECK_EQ(balanced_part(r, 3, 0).size(), 4u);
+    CHECK_EQ(balanced_part(r, 3, 2)[0], 7);
+}
+
+TEST_CASE_EX(rangex_test, fill_matches_iteration) {
+    auto verify = [](auto r) {
+        using T = decltype(r[0]);
+        std::vector<T> expect;
+        for (auto v : r) {
+            expect.push_back(v);
+        }
+        std::vector<T> got(expect.size() + 3);
+        CHECK_EQ(r.fill(0, got.data(), got.size()), expect.size());
+        CHECK(std::equal(expect.begin(), expect.end(), got.begin()));
+        CHECK_EQ(r.fill(2, got.data(), 3), std::min<std::size_t>(3, expect.size() - std::min<std::size_t>(2, expect.size())));
+    };
+    verify(rangex<uint8_t>(200, 0, true, -7));
+    CHECK_EQ(rangex<uint8_t>(200, 0, true, -7)[28], 4);
+    verify(rangex<int>(1, 100, true, 3));
+    verify(rangex<std::int64_t>(-5, 5));
+    verify(rangex<std::float32_t>(scf<32>(1.0f), scf<32>(9.0f), false, scf<32>(0.5f)));
+    verify(rangex<std::float64_t>(scf<64>(5.0), scf<64>(1.0), true, scf<64>(-0.25)));
+}
+
+TEST_CASE_EX(rangex_test, any_rangex_batches) {
+    any_rangex r = any_rangex::make(element_kind::u16, 0, 1000, false, 3);
+    CHECK(r.kind() == element_kind::u16);
+    CHECK_EQ(r.size(), 334u);
+
+    std::uint16_t buffer[64];
+    std::size_t batches = 0;
+    std::vector<std::uint16_t> got;
+    r.for_each_batch(std::span(buffer), [&](std::span<const std::uint16_t> batch) {
+        batches++;
+        got.insert(got.end(), batch.begin(), batch.end());
+    });
+    CHECK_EQ(batches, 6u);
+    std::vector<std::uint16_t> expect;
+    for (auto v : rangex<std::uint16_t>(0, 1000, false, 3)) {
+        expect.push_back(v);
+    }
+    CHECK(got == expect);
+
+    any_rangex rf = rangex<std::float64_t>(scf<64>(1.0), scf<64>(2.0), true, scf<64>(0.25));
+    CHECK(rf.kind() == element_kind::f64);
+    double values[8] = {};
+    CHECK_EQ(rf.fill(1, std::span(values)), 4u);
+    CHECK_EQ(values[0], 1.25);
+    CHECK_EQ(values[3], 2.0);
+    CHECK_EQ(rf.get<double>().size(), 5u);
+
+    // Copy holds its own range, type mismatch is reported
+    any_rangex copy = r;
+    r = any_rangex::make(element_kind::i8, 10, -10, true, -5);
+    CHECK_EQ(copy.size(), 334u);
+    CHECK_EQ(r.size(), 5u);
+    EXPECT_THROW(r.fill(0, std::span(values)), std::invalid_argument);
+    EXPECT_THROW(r.get<std::uint8_t>(), std::invalid_argument);
+
+    // Config values that do not fit the element (or step) type are rejected, not cast
+    EXPECT_THROW(any_rangex::make(element_kind::u8, -1, 10), std::invalid_argument);
+    EXPECT_THROW(any_rangex::make(element_kind::u8, 0, 256), std::invalid_argument);
+    EXPECT_THROW(any_rangex::make(element_kind::u8, 0, 250, false, 200), std::invalid_argument);
+    EXPECT_THROW(any_rangex::make(element_kind::i16, 0.5, 10), std::invalid_argument);
+    EXPECT_THROW(any_rangex::make(element_kind::u64, 0, 18446744073709551616.0), std::invalid_argument);
+    EXPECT_THROW(any_rangex::make(element_kind::i64, -9223372036854775808.0, 9223372036854775808.0), std::invalid_argument);
+    EXPECT_THROW(any_rangex::make(element_kind::f32, 0, 1e300), std::invalid_argument);
+    EXPECT_THROW(any_rangex::make(element_kind::f64, 0, 1, false, std::nan("")), std::invalid_argument);
+    CHECK_EQ(any_rangex::make(element_kind::u8, 0, 255, true, 127).size(), 3u);
+    CHECK_EQ(any_rangex::make(element_kind::i8, -128, 127, true, 127).size(), 3u);
+    CHECK_EQ(any_rangex::make(element_kind::i64, -9223372036854775808.0, 0).size(), std::size_t{1} << 63);
+
+    // Float values do not depend on where a batch starts, so neither on the buffer size
+    const auto tenths = rangex<float>(0.0f, 100.0f, false, 0.1f);
+    std::vector<float> whole(tenths.size());
+    CHECK_EQ(tenths.fill(0, whole.data(), whole.size()), tenths.size());
+    std::vector<float> tail(500);
+    CHECK_EQ(tenths.fill(500, tail.data(), tail.size()), 500u);
+    for (std::size_t k = 0; k < 500; ++k) {
+        CHECK_EQ(whole[k], tenths[k]);
+        CHECK_EQ(tail[k], whole[500 + k]);
+    }
+    any_rangex af = tenths;
+    for (std::size_t batch : {1, 7, 64, 1000}) {
+        std::vector<float> buf(batch);
+        std::vector<float> seen;
+        af.for_each_batch(std::span(buf), [&seen](std::span<const float> b) { seen.insert(seen.end(), b.begin(), b.end()); });
+        CHECK(seen == whole);
+    }
+}
+
+// Inverse queries against a linear scan of the values
+template <typename Lookup, typename T>
+void verify_inverse_queries(const Lookup& lookup, rangex<T> r, std::vector<T> probes) {
+    // Queries are against r[k], iterated floats may differ from it in the last bits
+    std::vector<T> values;
+    for (std::size_t k = 0; k < r.size(); ++k) {
+        values.push_back(r[k]);
+    }
+    const bool ascending = values.size() < 2 || values[0] < values[1];
+    auto before = [ascending](T a, T b) { return ascending ? a < b : a > b; };
+    for (T v : probes) {
+        SCOPED_TRACE(testing::Message() << "probe " << +v << " range size " << values.size());
+        auto found = std::find(values.begin(), values.end(), v);
+        std::size_t lower = 0, upper = 0;
+        while (lower < values.size() && before(values[lower], v)) {
+            lower++;
+        }
+        while (upper < values.size() && !before(v, values[upper])) {
+            upper++;
+        }
+        CHECK_EQ(lookup.contains(v), found != values.end());
+        CHECK(lookup.index_of(v) == (found != values.end() ? std::optional<std::size_t>(found - values.begin()) : std::nullopt));
+        CHECK_EQ(lookup.lower_bound(v), lower);
+        CHECK_EQ(lookup.upper_bound(v), upper);
+        if (!values.empty()) {
+            T nearest = values[0];
+            for (T candidate : values) {
+                auto distance = [](T a, T b) {
+                    using D = make_distance_t<T>;
+                    return a < b ? static_cast<D>(static_cast<D>(b) - static_cast<D>(a)) : static_cast<D>(static_cast<D>(a) - static_cast<D>(b));
+                };
+                // Ties go to the later value
+                if (distance(candidate, v) <= distance(nearest, v)) {
+                    nearest = candidate;
+                }
+            }
+            CHECK_EQ(lookup.clamp_to_grid(v), nearest);
+        }
+    }
+}
+
+template <typename T>
+void verify_inverse_queries_all(rangex<T> r, std::vector<T> probes) {
+    verify_inverse_queries(r, r, probes);
+    verify_inverse_queries(rangex_lookup<T>(r), r, probes);
+}
+
+TEST_CASE_EX(rangex_test, inverse_queries_closed_form) {
+    std::vector<int> int_probes;
+    for (int v = -20; v <= 120; ++v) {
+        int_probes.push_back(v);
+    }
+    verify_inverse_queries_all<int>(rangex<int>(1, 100, true, 3), int_probes);
+    verify_inverse_queries_all<int>(rangex<int>(1, 100, false, 1), int_probes);
+    verify_inverse_queries_all<int>(rangex<int>(100, -10, true, -7), int_probes);
+    verify_inverse_queries_all<int>(rangex<int>(5, 5), int_probes);
+
+    std::vector<uint8_t> u8_probes;
+    for (int v = 0; v <= 255; ++v) {
+        u8_probes.push_back(static_cast<uint8_t>(v));
+    }
+    verify_inverse_queries_all<uint8_t>(rangex<uint8_t>(5, 0, true, -1), u8_probes);
+    verify_inverse_queries_all<uint8_t>(rangex<uint8_t>(200, 3, true, -7), u8_probes);
+    verify_inverse_queries_all<uint8_t>(rangex<uint8_t>(10, 250, false, 9), u8_probes);
+
+    std::vector<std::int64_t> i64_probes = { INT64_MIN, -1000000000000LL, -5, 0, 7, 999999999999LL, 1000000000000LL, INT64_MAX };
+    verify_inverse_queries_all<std::int64_t>(rangex<std::int64_t>(-1000000000000LL, 1000000000000LL, true, 1000000007LL), i64_probes);
+    std::vector<std::uint64_t> u64_probes = { 0, 1, 6000000000ull, 6000000001ull, 9000000000ull, 0xFFFFFFFFFFFFFFFFull };
+    verify_inverse_queries_all<std::uint64_t>(rangex<std::uint64_t>(0, 9000000000ull, true, 3000000000), u64_probes);
+
+    std::vector<std::float64_t> f64_probes;
+    for (int v = -10; v <= 50; ++v) {
+        f64_probes.push_back(scf<64>(v * 0.125));
+    }
+    f64_probes.push_back(scf<64>(1.3));
+    verify_inverse_queries_all<std::float64_t>(rangex<std::float64_t>(scf<64>(0.0), scf<64>(4.0), true, scf<64>(0.25)), f64_probes);
+    verify_inverse_queries_all<std::float64_t>(rangex<std::float64_t>(scf<64>(4.0), scf<64>(0.5), false, scf<64>(-0.5)), f64_probes);
+    std::vector<std::float32_t> f32_probes;
+    for (int v = -3; v <= 15; ++v) {
+        f32_probes.push_back(scf<32>(v * 0.1f));
+    }
+    verify_inverse_queries_all<std::float32_t>(rangex<std::float32_t>(scf<32>(0.0f), scf<32>(0.95f), false, scf<32>(0.1f)), f32_probes);
+
+    static_assert(rangex<int>(0, 100, false, 10).index_of(30) == 3);
+    static_assert(rangex_lookup<int>(rangex<int>(0, 100, false, 10)).lower_bound(31) == 4);
+    CHECK(!rangex<std::float64_t>(scf<64>(0.0), scf<64>(1.0)).contains(std::nan("")));
+}
+
+TEST_CASE_EX(rangex_test, fast_divider_matches_hardware_division) {
+    for (std::uint32_t d : {1u, 2u, 3u, 7u, 10u, 641u, 65537u, 0x7FFFFFFFu, 0xFFFFFFFFu}) {
+        fast_divider<std::uint32_t> div(d);
+        for (std::uint32_t n : {0u, 1u, d - 1, d, d + 1, 123456789u, 0xFFFFFFFEu, 0xFFFFFFFFu}) {
+            CHECK_EQ(div.div(n), n / d);
+        }
+    }
+    // 64 bits: shifts, multiplies with and without the add fixup (7 needs it, 3 does not), d and n past 2^32
+    std::uint64_t x = 88172645463325252ull;
+    for (std::uint64_t d : {1ull, 2ull, 3ull, 7ull, 1000000007ull, 0x100000000ull, 0x100000001ull, 0x123456789ABCDEFull,
+             0x8000000000000000ull, 0x8000000000000001ull, 0xFFFFFFFFFFFFFFFEull, 0xFFFFFFFFFFFFFFFFull}) {
+        fast_divider<std::uint64_t> div(d);
+        for (std::uint64_t n : std::initializer_list<std::uint64_t>{0, 5, d - 1, d, d + 1, 2 * d - 1, 0xFFFFFFFFull, 0x100000000ull,
+                 0x7FFFFFFFFFFFFFFFull, 0xFFFFFFFFFFFFFFFEull, 0xFFFFFFFFFFFFFFFFull}) {
+            CHECK_EQ(div.div(n), n / d);
+        }
+        for (int k = 0; k < 1000; ++k) {
+            x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+            const std::uint64_t n = x >> (k % 64);
+            CHECK_EQ(div.div(n), n / d);
+        }
+    }
+    // Up to 32 bits the power of two d are folded into the multiply, no branch to take
+    for (int l = 0; l < 32; ++l) {
+        const std::uint32_t d = std::uint32_t{1} << l;
+        for (std::uint32_t n : {0u, 1u, d - 1, d, d + 1, 0xFFFFFFFFu}) {
+            CHECK_EQ(fast_divider<std::uint32_t>(d).div(n), n / d);
+        }
+    }
+    for (int k = 0; k < 10000; ++k) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        const std::uint32_t d = static_cast<std::uint32_t>(x >> (k % 32 + 32)) | 1;
+        const std::uint32_t n = static_cast<std::uint32_t>(x);
+        CHECK_EQ(fast_divider<std::uint32_t>(d).div(n), n / d);
+        CHECK_EQ(fast_divider<std::uint16_t>(static_cast<std::uint16_t>(d | 0x100) >> (k % 9)).div(static_cast<std::uint16_t>(n)),
+            static_cast<std::uint16_t>(n) / (static_cast<std::uint16_t>(d | 0x100) >> (k % 9)));
+        CHECK_EQ(fast_divider<std::uint8_t>(static_cast<std::uint8_t>(k % 255 + 1)).div(static_cast<std::uint8_t>(n)),
+            static_cast<std::uint8_t>(n) / (k % 255 + 1));
+    }
+    for (int k = 0; k < 10000; ++k) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        const std::uint64_t d = (x >> (k % 64)) | 1;
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        CHECK_EQ(fast_divider<std::uint64_t>(d).div(x), x / d);
+    }
+    static_assert(fast_divider<std::uint64_t>(7).div(0xFFFFFFFFFFFFFFFFull) == 0xFFFFFFFFFFFFFFFFull / 7);
+    static_assert(fast_divider<std::uint64_t>(0x100000003ull).div(0xFFFFFFFFFFFFFFFFull) == 0xFFFFFFFFFFFFFFFFull / 0x100000003ull);
+    static_assert(fast_divider<std::uint64_t>(1).div(0xFFFFFFFFFFFFFFFFull) == 0xFFFFFFFFFFFFFFFFull);
+    static_assert(fast_divider<std::uint32_t>(1).div(0xFFFFFFFFu) == 0xFFFFFFFFu);
+    CHECK_EQ(mulhi64(0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFFFFFFFFFFull), 0xFFFFFFFFFFFFFFFEull);
+}
+
+// Bin of each value by a linear scan of the edges r[k]
+template <typename T>
+histogram_result reference_histogram(const rangex<T>& edges, const std::vector<T>& data) {
+    histogram_result result;
+    result.bins.assign(edges.size() > 1 ? edges.size() - 1 : 0, 0);
+    const bool ascending = edges.size() < 2 || edges[0] < edges[1];
+    auto before = [ascending](T a, T b) { return ascending ? a < b : a > b; };
+    for (T v : data) {
+        if (v != v) {
+            result.nan++;
+            continue;
+        }
+        std::size_t after = 0;
+        while (after < edges.size() && !before(v, edges[after])) {
+            after++;
+        }
+        if (0 == after) {
+            result.underflow++;
+        } else if (after - 1 < result.bins.size()) {
+            result.bins[after - 1]++;
+        } else {
+            result.overflow++;
+        }
+    }
+    return result;
+}
+
+template <typename T>
+void verify_histogram(const rangex<T>& edges, const std::vector<T>& data) {
+    SCOPED_TRACE(testing::Message() << "edges from " << +edges[0] << " size " << edges.size());
+    const histogram_result expect = reference_histogram(edges, data);
+    for (std::size_t threads : {1, 3}) {
+        const histogram_result got = histogram(edges, std::span<const T>(data), threads);
+        CHECK(got.bins == expect.bins);
+        CHECK_EQ(got.underflow, expect.underflow);
+        CHECK_EQ(got.overflow, expect.overflow);
+        CHECK_EQ(got.nan, expect.nan);
+    }
+    // Every kernel the CPU can run, not only the one picked at run time
+    for (auto isa : {histogram_detail::simd_isa::scalar, histogram_detail::simd_isa::avx2, histogram_detail::simd_isa::avx512}) {
+        if (static_cast<int>(isa) > static_cast<int>(histogram_detail::detected_isa())) {
+            continue;
+        }
+        SCOPED_TRACE(testing::Message() << "isa " << static_cast<int>(isa));
+        histogram_result got;
+        got.bins.assign(expect.bins.size(), 0);
+        histogram_detail::count_into(edges, std::span<const T>(data), got, isa);
+        CHECK(got.bins == expect.bins);
+        CHECK_EQ(got.underflow, expect.underflow);
+        CHECK_EQ(got.overflow, expect.overflow);
+        CHECK_EQ(got.nan, expect.nan);
+    }
+}
+
+TEST_CASE_EX(rangex_test, histogram_over_rangex_edges) {
+    std::vector<float> f32;
+    for (int k = -300; k < 1300; ++k) {
+        f32.push_back(k * 0.01f);
+        f32.push_back(k * 0.1f + 0.05f);
+    }
+    // Exactly on the edges r[k], where the reciprocal alone could pick the lower bin
+    auto f32_edges = rangex<float>(0.0f, 10.0f, true, 0.1f);
+    for (std::size_t k = 0; k < f32_edges.size(); ++k) {
+        f32.push_back(f32_edges[k]);
+    }
+    f32.push_back(std::nanf(""));
+    f32.push_back(std::numeric_limits<float>::infinity());
+    f32.push_back(-std::numeric_limits<float>::infinity());
+    verify_histogram(f32_edges, f32);
+    verify_histogram(rangex<float>(-1.0f, 1.0f, false, 0.25f), f32);
+    verify_histogram(rangex<float>(5.0f, -1.0f, true, -0.5f), f32);
+    verify_histogram(rangex<float>(0.0f, 0.0f, true, 1.0f), f32);
+    // Edges far from zero compared to the step, the scalar path must still compare on edges
+    std::vector<float> far;
+    const auto far_edges = rangex<float>(1000.0f, 1001.0f, true, 0.001f);
+    for (std::size_t k = 0; k < far_edges.size(); ++k) {
+        far.push_back(far_edges[k]);
+        far.push_back(std::nextafter(far_edges[k], 0.0f));
+        far.push_back(std::nextafter(far_edges[k], 2000.0f));
+    }
+    verify_histogram(far_edges, far);
+
+    std::vector<double> f64(f32.begin(), f32.end());
+    verify_histogram(rangex<double>(0.0, 10.0, true, 0.1), f64);
+    verify_histogram(rangex<double>(-3.0, 13.0, false, 0.7), f64);
+    std::vector<double> far64(far.begin(), far.end());
+    verify_histogram(rangex<double>(1000.0, 1001.0, true, 0.001), far64);
+
+    std::vector<int> i32;
+    for (int k = -500; k < 1500; k += 3) {
+        i32.push_back(k);
+    }
+    verify_histogram(rangex<int>(0, 1000, true, 7), i32);
+    verify_histogram(rangex<int>(900, 0, true, -30), i32);
+    verify_histogram(rangex<int>(-2000000000, 2000000000, true, 1000000007), i32);
+    i32.push_back(INT32_MIN);
+    i32.push_back(INT32_MAX);
+    verify_histogram(rangex<int>(-499, 1400, false, 1), i32);
+    std::vector<uint8_t> u8;
+    for (int k = 0; k < 256; ++k) {
+        u8.push_back(static_cast<uint8_t>(k));
+    }
+    verify_histogram(rangex<uint8_t>(16, 240, true, 16), u8);
+}
+
+// Random non-dyadic steps with data on every edge r[k] and one ulp either side: the edge compares
+// of every kernel must round the edges like rangex::operator[], dyadic steps hide any difference
+template <typename T>
+void verify_histogram_random_steps(std::uint64_t seed) {
+    std::uint64_t x = seed;
+    const auto next = [&x] {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        return x;
+    };
+    for (int trial = 0; trial < 40; ++trial) {
+        const T start = static_cast<T>(static_cast<double>(next() % 200001) / 100.0 - 1000.0);
+        const T step = static_cast<T>(static_cast<double>(next() % 100000 + 1) / 9973.0);
+        const std::size_t bins = next() % 3000 + 1;
+        const auto edges = rangex<T>(start, static_cast<T>(start + static_cast<T>(bins) * step), false, step);
+        std::vector<T> data;
+        for (std::size_t k = 0; k < edges.size(); ++k) {
+            data.push_back(edges[k]);
+            data.push_back(std::nextafter(edges[k], -std::numeric_limits<T>::infinity()));
+            data.push_back(std::nextafter(edges[k], std::numeric_limits<T>::infinity()));
+        }
+        verify_histogram(edges, data);
+    }
+}
+
+TEST_CASE_EX(rangex_test, histogram_on_edges_with_random_steps) {
+    verify_histogram_random_steps<float>(88172645463325252ull);
+    verify_histogram_random_steps<double>(2463534242ull);
+}
+
+TEST_CASE_EX(rangex_test, overflow_policy_checked_and_widen) {
+    // Span of 200 does not fit int8_t, widen computes it in the unsigned distance type
+    auto wide = rangex<int8_t, false, false, overflow_policy::widen>(-100, 100);
+    CHECK_EQ(wide.size(), 200u);
+    CHECK_EQ(wide[0], -100);
+    CHECK_EQ(wide[199], 99);
+    int count = 0;
+    int expect = -100;
+    for (auto v : wide) {
+        CHECK_EQ(v, expect);
+        ++expect;
+        ++count;
+    }
+    CHECK_EQ(count, 200);
+    EXPECT_THROW((rangex<int8_t, false, false, overflow_policy::checked>(-100, 100)), std::overflow_error);
+    EXPECT_THROW((rangex<int64_t, false, false, overflow_policy::checked>(INT64_MAX, INT64_MIN, true, -1)), std::overflow_error);
+
+    // Descending unsigned ranges with |step| > 1
+    auto down = rangex<uint8_t, false, false, overflow_policy::widen>(200, 3, true, -7);
+    CHECK_EQ(down.size(), 29u);
+    CHECK_EQ(down[28], 4);
+    auto down_checked = rangex<uint8_t, false, false, overflow_policy::checked>(200, 3, true, -7);
+    CHECK_EQ(down_checked.size(), 29u);
+    auto down64 = rangex<uint64_t, false, false, overflow_policy::widen>(UINT64_MAX, 0, true, -(int64_t(1) << 62));
+    CHECK_EQ(down64.size(), 4u);
+    CHECK_EQ(down64[3], UINT64_MAX - 3 * (uint64_t(1) << 62));
+    auto full = rangex<int64_t, false, false, overflow_policy::widen>(INT64_MIN, INT64_MAX, true, int64_t(1) << 62);
+    CHECK_EQ(full.size(), 4u);
+    CHECK_EQ(static_cast<uint64_t>(full[3]), static_cast<uint64_t>(INT64_MIN) + 3 * (uint64_t(1) << 62));
+    auto last = rangex<int32_t, false, false, overflow_policy::widen>(INT32_MAX - 10, INT32_MAX, true, 3);
+    std::vector<int32_t> tail;
+    for (auto v : last) {
+        tail.push_back(v);
+    }
+    CHECK_EQ(tail.size(), 4u);
+    CHECK_EQ(tail.back(), INT32_MAX - 1);
+
+    // Without overflow every policy gives the same range
+    for (int step : {1, 3, 7, -1, -4}) {
+        for (int inclusive = 0; inclusive < 2; ++inclusive) {
+            auto plain = rangex<int16_t>(step > 0 ? -50 : 90, step > 0 ? 90 : -50, inclusive, step);
+            auto checked = rangex<int16_t, false, false, overflow_policy::checked>(step > 0 ? -50 : 90, step > 0 ? 90 : -50, inclusive, step);
+            auto widened = rangex<int16_t, false, false, overflow_policy::widen>(step > 0 ? -50 : 90, step > 0 ? 90 : -50, inclusive, step);
+            CHECK_EQ(plain.size(), checked.size());
+            CHECK_EQ(plain.size(), widened.size());
+            for (std::size_t k = 0; k < plain.size(); ++k) {
+                CHECK_EQ(plain[k], checked[k]);
+                CHECK_EQ(plain[k], widened[k]);
+            }
+        }
+    }
+    // Every value of a 64-bit type is one more trip than std::size_t holds
+    EXPECT_THROW((rangex<uint64_t, false, false, overflow_policy::widen>(0, UINT64_MAX, true)), std::overflow_error);
+    EXPECT_THROW((rangex<uint64_t, false, false, overflow_policy::checked>(0, UINT64_MAX, true)), std::overflow_error);
+    EXPECT_THROW((rangex<int64_t, false, false, overflow_policy::widen>(INT64_MIN, INT64_MAX, true)), std::overflow_error);
+    EXPECT_THROW((rangex<uint64_t, false, false, overflow_policy::widen>(UINT64_MAX, 0, true, -1)), std::overflow_error);
+    CHECK_EQ((rangex<uint64_t, false, false, overflow_policy::widen>(0, UINT64_MAX).size()), std::size_t{UINT64_MAX});
+    CHECK_EQ((rangex<uint64_t, false, false, overflow_policy::checked>(0, UINT64_MAX).size()), std::size_t{UINT64_MAX});
+    CHECK_EQ((rangex<int64_t, false, false, overflow_policy::widen>(INT64_MIN, INT64_MAX, true, 2).size()), std::size_t{1} << 63);
+    static_assert(rangex<uint8_t, false, false, overflow_policy::widen>(0, 255, true).size() == 256);
+    static_assert(rangex<uint8_t, false, false, overflow_policy::checked>(250, 10, false, -20).size() == 12);
+}
+
+TEST_CASE_EX(rangex_test, overflow_policy_floating_trip_count) {
+    // More than INT_MAX steps, the trip count stays in T until it is checked against std::size_t
+    CHECK_EQ((rangex<double, false, false, overflow_policy::checked>(0.0, 3e9).size()), std::size_t{3000000000});
+    CHECK_EQ((rangex<double, false, false, overflow_policy::widen>(0.0, 3e9, true).size()), std::size_t{3000000001});
+    CHECK_EQ((rangex<float>(0.0f, 3e9f, false, -1.0f).size()), 0u);
+    CHECK_EQ((rangex<float, false, false, overflow_policy::checked>(3e9f, 0.0f, false, -1.0f).size()), std::size_t{3000000000});
+    const auto big = rangex<double>(0.0, 3.7e14, false, 0.37);
+    CHECK(big.size() >= std::size_t{1000000000000000} - 1 && big.size() <= std::size_t{1000000000000000} + 1);
+    // Beyond std::size_t
+    EXPECT_THROW((rangex<double, false, false, overflow_policy::checked>(0.0, 1e20)), std::overflow_error);
+    EXPECT_THROW((rangex<float, false, false, overflow_policy::widen>(-1e30f, 1e30f, false, 1e5f)), std::overflow_error);
+    CHECK_EQ((rangex<double>(0.0, 1e20).size()), std::numeric_limits<std::size_t>::max());
+    static_assert(rangex<double, false, false, overflow_policy::checked>(0.0, 3e9).size() == 3000000000);
+}
+
+TEST_CASE_EX(rangex_test, parallel_reduce_bit_identical_across_threads) {
+    const auto r = rangex<double>(0.0, 10.0, false, 1e-5);
+    const auto wave = [](double x) { return std::sin(x) * 1e6 + 1.0 / (1.0 + x); };
+    for (auto compensation : {reduce_compensation::none, reduce_compensation::kahan, reduce_compensation::pairwise}) {
+        const double one = parallel_reduce(r, 0.5, wave, std::plus<>(), 1, compensation);
+        for (std::size_t threads = 2; threads <= 8; ++threads) {
+            const double many = parallel_reduce(r, 0.5, wave, std::plus<>(), threads, compensation);
+            CHECK_EQ(std::memcmp(&one, &many, sizeof(double)), 0);
+        }
+        // Leaf blocks that do not divide the trip count
+        const double odd = parallel_reduce(r, 0.5, wave, std::plus<>(), 1, compensation, 1000);
+        for (std::size_t threads = 2; threads <= 8; threads += 3) {
+            const double many = parallel_reduce(r, 0.5, wave, std::plus<>(), threads, compensation, 1000);
+            CHECK_EQ(std::memcmp(&odd, &many, sizeof(double)), 0);
+        }
+    }
+
+    // Compensated float sums stay close to the double result
+    const auto rf = rangex<float>(0.0f, 1.0f, false, 1.0f / (1 << 20));
+    const auto tenth = [](float x) { return x * 0.1f; };
+    double exact = 0;
+    for (std::size_t k = 0; k < rf.size(); ++k) {
+        exact += static_cast<double>(rf[k]) * 0.1;
+    }
+    const float kahan = parallel_reduce(rf, 0.0f, tenth, std::plus<>(), 4, reduce_compensation::kahan);
+    const float pairwise = parallel_reduce(rf, 0.0f, tenth, std::plus<>(), 4, reduce_compensation::pairwise);
+    CHECK(std::abs(kahan - exact) < exact * 1e-6);
+    CHECK(std::abs(pairwise - exact) < exact * 1e-6);
+
+    // Any associative combine and any range with subrange()
+    auto ints = rangex<int64_t>(-1000, 100000, true, 3);
+    int64_t sum = 0;
+    int64_t max = INT64_MIN;
+    for (auto v : ints) {
+        sum += v * v;
+        max = std::max(max, v % 977);
+    }
+    CHECK_EQ(parallel_reduce(ints, int64_t{0}, [](int64_t v) { return v * v; }, std::plus<>(), 3, reduce_compensation::none, 100), sum);
+    CHECK_EQ(parallel_reduce(ints, INT64_MIN, [](int64_t v) { return v % 977; },
+        [](int64_t a, int64_t b) { return std::max(a, b); }, 5, reduce_compensation::pairwise, 64), max);
+    std::size_t pairs = parallel_reduce(triangular_rangex(300), std::size_t{0},
+        [](auto p) { return p.second - p.first; }, std::plus<>(), 4, reduce_compensation::none, 500);
+    std::size_t expect_pairs = 0;
+    for (std::size_t j = 0; j < 300; ++j) {
+        expect_pairs += j * (j + 1) / 2;
+    }
+    CHECK_EQ(pairs, expect_pairs);
+    CHECK_EQ(parallel_reduce(rangex<int>(5, 5), 42, [](int v) { return v; }, std::plus<>(), 4), 42);
+
+    // Kahan only adds, any other combine is refused instead of silently summed
+    const auto max_combine = [](double a, double b) { return std::max(a, b); };
+    EXPECT_THROW(parallel_reduce(r, 0.0, wave, max_combine, 4, reduce_compensation::kahan), std::invalid_argument);
+    EXPECT_THROW(parallel_reduce(r, 1.0, wave, std::multiplies<>(), 1, reduce_compensation::kahan), std::invalid_argument);
+    EXPECT_THROW(parallel_reduce(rangex<int>(5, 5), 42, [](int v) { return v; }, max_combine, 1, reduce_compensation::kahan),
+        std::invalid_argument);
+    CHECK_EQ(parallel_reduce(rf, 0.0f, tenth, std::plus<float>(), 2, reduce_compensation::kahan), kahan);
+    CHECK_EQ(parallel_reduce(r, 0.0, wave, max_combine, 4, reduce_compensation::pairwise),
+        parallel_reduce(r, 0.0, wave, max_combine, 1, reduce_compensation::none));
+}
+
+TEST_CASE_EX(rangex_test, resumable_cursor_budget_and_checkpoint) {
+    const auto r = rangex<int>(-5000, 100000, false, 7);
+    std::vector<int> expect;
+    for (auto v : r) {
+        expect.push_back(v);
+    }
+
+    // Element budget slices, then checkpoint halfway and continue in a new cursor
+    std::vector<int> got;
+    resumable_cursor<rangex<int>, 64> cursor(r);
+    CHECK_EQ(cursor.run_for(std::size_t{1000}, [&got](int v) { got.push_back(v); }), 1000u);
+    CHECK_EQ(cursor.position(), 1000u);
+    while (cursor.position() < r.size() / 2) {
+        cursor.run_for(std::size_t{333}, [&got](int v) { got.push_back(v); });
+    }
+    std::uint8_t state[resumable_cursor<rangex<int>, 64>::max_state_size];
+    std::size_t state_size = cursor.save(std::span(state));
+    CHECK_EQ(state_size, 2u);
+
+    resumable_cursor<rangex<int>, 64> restored(r);
+    CHECK(restored.restore(std::span<const std::uint8_t>(state, state_size)));
+    CHECK_EQ(restored.position(), cursor.position());
+    // Deadline already passed: one slice of CheckEvery values still runs
+    CHECK_EQ(restored.run_for(resumable_cursor<rangex<int>, 64>::clock::now(), [&got](int v) { got.push_back(v); }), 64u);
+    while (!restored.done()) {
+        restored.run_for(std::chrono::microseconds(50), [&got](int v) { got.push_back(v); });
+    }
+    CHECK(got == expect);
+    CHECK_EQ(restored.run_for(std::size_t{10}, [](int) {}), 0u);
+
+    // Malformed states leave the cursor where it was
+    const std::uint8_t truncated[] = {0x81};
+    const std::uint8_t past_end[] = {0xFF, 0xFF, 0x7F};
+    const std::uint8_t trailing[] = {0x01, 0x00};
+    const std::uint8_t overlong[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02};
+    CHECK(!restored.restore(std::span(truncated)));
+    CHECK(!restored.restore(std::span(past_end)));
+    CHECK(!restored.restore(std::span(trailing)));
+    CHECK(!restored.restore(std::span(overlong)));
+    CHECK(!restored.restore(std::span<const std::uint8_t>()));
+    CHECK(restored.done());
+
+    // Largest position round trips through all the bytes
+    const auto huge = rangex<uint64_t>(0, UINT64_MAX);
+    resumable_cursor far(huge, UINT64_MAX - 1);
+    std::uint8_t far_state[decltype(far)::max_state_size];
+    CHECK_EQ(far.save(std::span(far_state)), decltype(far)::max_state_size);
+    resumable_cursor back(huge);
+    CHECK(back.restore(std::span<const std::uint8_t>(far_state)));
+    CHECK_EQ(back.position(), UINT64_MAX - 1);
+    uint64_t last = 0;
+    CHECK_EQ(back.run_for(std::size_t{5}, [&last](uint64_t v) { last = v; }), 1u);
+    CHECK_EQ(last, UINT64_MAX - 1);
+}
+
+TEST_CASE_EX(rangex_test, resumable_cursor_float_values_do_not_depend_on_slicing) {
+    // A float range-for adds step to the previous value, the cursor hands out r[k] whatever the slices
+    const auto r = rangex<float>(-3.0f, 1000.0f, false, 0.1f);
+    for (std::size_t budget : {std::size_t{1}, std::size_t{7}, std::size_t{64}, std::size_t{1000}, r.size()}) {
+        std::vector<float> got;
+        resumable_cursor<rangex<float>, 16> cursor(r);
+        while (!cursor.done()) {
+            // Checkpoint and continue in a new cursor after every slice
+            std::uint8_t state[decltype(cursor)::max_state_size];
+            const std::size_t state_size = cursor.save(std::span(state));
+            resumable_cursor<rangex<float>, 16> next(r);
+            CHECK(next.restore(std::span<const std::uint8_t>(state, state_size)));
+            next.run_for(budget, [&got](float v) { got.push_back(v); });
+            cursor.seek(next.position());
+        }
+        CHECK_EQ(got.size(), r.size());
+        bool same = got.size() == r.size();
+        for (std::size_t k = 0; same && k < got.size(); ++k) {
+            const float expect = r[k];
+            same = 0 == std::memcmp(&got[k], &expect, sizeof(float));
+        }
+        CHECK(same);
+    }
+
+    // Index of an indexed range is the trip index, not the position within the slice
+    const auto indexed = rangex<int, true>(10, 20);
+    resumable_cursor<rangex<int, true>, 4> cursor(indexed);
+    std::vector<std::size_t> indices;
+    while (!cursor.done()) {
+        cursor.run_for(std::size_t{3}, [&indices](auto v) { indices.push_back(v.first); });
+    }
+    CHECK_EQ(indices.size(), 10u);
+    for (std::size_t k = 0; k < indices.size(); ++k) {
+        CHECK_EQ(indices[k], k);
+    }
+}
+
+TEST_CASE_EX(rangex_test, bit_reversed_and_gray_code_orders) {
+    for (unsigned bits = 0; bits <= 12; ++bits) {
+        const std::size_t n = std::size_t{1} << bits;
+        const auto r = rangex<uint32_t>(0, static_cast<uint32_t>(n));
+        const auto br = bit_reversed(r);
+        const auto gc = gray_code(r);
+        CHECK_EQ(br.size(), n);
+        std::size_t k = 0;
+        std::vector<bool> seen(n, false);
+        for (auto j : br) {
+            // Naive reversal of the low `bits` bits
+            uint32_t expect = 0;
+            for (unsigned b = 0; b < bits; ++b) {
+                expect |= ((k >> b) & 1u) << (bits - 1 - b);
+            }
+            CHECK_EQ(j, expect);
+            CHECK_EQ(br[k], expect);
+            seen[j] = true;
+            ++k;
+        }
+        CHECK_EQ(k, n);
+        CHECK(std::find(seen.begin(), seen.end(), false) == seen.end());
+        k = 0;
+        uint32_t prev = 0;
+        for (auto g : gc) {
+            CHECK_EQ(g, static_cast<uint32_t>(k ^ (k >> 1)));
+            CHECK_EQ(gc[k], g);
+            if (k > 0) {
+                CHECK(std::has_single_bit(g ^ prev));
+            }
+            prev = g;
+            ++k;
+        }
+        CHECK_EQ(k, n);
+    }
+
+    // Values of the underlying range, subranges and batches agree with operator[]
+    const auto f = bit_reversed(rangex<double>(1.0, 1.0 + 64 * 0.5, false, 0.5));
+    CHECK_EQ(f.size(), 64u);
+    CHECK_EQ(f[1], 1.0 + 32 * 0.5);
+    for (std::size_t parts = 1; parts <= 5; ++parts) {
+        std::size_t k = 0;
+        for (std::size_t p = 0; p < parts; ++p) {
+            for (auto v : balanced_part(f, parts, p)) {
+                CHECK_EQ(v, f[k]);
+                ++k;
+            }
+        }
+        CHECK_EQ(k, f.size());
+    }
+    const auto g = gray_code(rangex<int>(0, 4)).subrange(4, 3);
+    CHECK(g.empty());
+    double batch[40];
+    CHECK_EQ(f.fill(30, batch, 40), 34u);
+    for (std::size_t k = 0; k < 34; ++k) {
+        CHECK_EQ(batch[k], f[30 + k]);
+    }
+    int gray_batch[16];
+    const auto gs = gray_code(rangex<int>(-8, 8)).subrange(3, 10);
+    CHECK_EQ(gs.fill(0, gray_batch, 16), 10u);
+    for (std::size_t k = 0; k < 10; ++k) {
+        CHECK_EQ(gray_batch[k], -8 + static_cast<int>((k + 3) ^ ((k + 3) >> 1)));
+    }
+    CHECK_EQ(parallel_reduce(bit_reversed(rangex<uint64_t>(0, 1 << 16)), uint64_t{0},
+        [](uint64_t v) { return v; }, std::plus<>(), 4, reduce_compensation::none, 1000), (uint64_t{1} << 16) * ((1 << 16) - 1) / 2);
+    static_assert(bit_reversed(rangex<int>(0, 8))[3] == 6);
+    static_assert(gray_code(rangex<int>(0, 8))[5] == 7);
+    EXPECT_THROW(bit_reversed(rangex<int>(0, 12)), std::invalid_argument);
+    EXPECT_THROW(gray_code(rangex<int>(0, 3)), std::invalid_argument);
+
+    // An empty range is a valid input, like an empty FFT
+    const auto none = bit_reversed(rangex<int>(5, 5));
+    CHECK(none.empty());
+    CHECK(!(none.begin() != none.end()));
+    CHECK(gray_code(rangex<double>(1.0, 1.0, false, 0.5)).empty());
+    CHECK_EQ(none.subrange(0, 4).size(), 0u);
+    int out[1] = {7};
+    CHECK_EQ(none.fill(0, out, 1), 0u);
+    CHECK_EQ(out[0], 7);
+    static_assert(bit_reversed(rangex<int>(0, 0)).size() == 0);
+}
+
+TEST_CASE_EX(rangex_test, range_for_over_span_that_wraps_type) {
+    // end - start does not fit in T, the loop must still stop after size() values
+    auto count_capped = [](auto r) {
+        std::size_t count = 0;
+        for (auto v : r) {
+            (void)v;
+            if (++count > 100000) {
+                break;
+            }
+        }
+        return count;
+    };
+    CHECK_EQ(rangex<int8_t>(-100, 100).size(), 200u);
+    CHECK_EQ(count_capped(rangex<int8_t>(-100, 100)), 200u);
+    CHECK_EQ(count_capped(rangex<int8_t>(100, -100, true, -3)), 67u);
+    CHECK_EQ(rangex<int16_t>(-20000, 20000).size(), 40000u);
+    CHECK_EQ(count_capped(rangex<int16_t>(-20000, 20000)), 40000u);
+    CHECK_EQ(count_capped(rangex<uint8_t>(250, 5, false, -5)), 49u);
+    int8_t last = 0;
+    for (auto v : rangex<int8_t>(-128, 127, true)) {
+        last = v;
+    }
+    CHECK_EQ(last, 127);
+    CHECK_EQ(rangex<int32_t>(INT32_MIN, INT32_MAX, true, 1 << 30).size(), 4u);
+}